@@ -21,12 +21,21 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <limits>
+#include <new>
 #include <string>
 #include <vector>
 
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 #include <fc/reflect/reflect.hpp>
+#include <fc/crypto/city.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw_fwd.hpp>
 
 namespace fc {
 
@@ -600,6 +609,368 @@ inline bloom_filter operator ^ (const bloom_filter& a, const bloom_filter& b)
    return result;
 }
 
+/**
+ * Cache-blocked variant of bloom_filter.
+ *
+ * Every key is hashed once with city_hash64 and mapped into a single 64 byte block (one cache line); the
+ * salt_count_ bits of the key are then derived inside that block via double hashing. A lookup therefore costs
+ * one hash and at most one cache miss regardless of the number of hash functions, at the price of a slightly
+ * higher false positive rate than bloom_filter for the same number of bits.
+ *
+ * insert_many/contains_many hash a batch of keys up front and prefetch their blocks before touching them, which
+ * overlaps the cache misses of the batch.
+ */
+class blocked_bloom_filter
+{
+public:
+
+   static constexpr std::size_t block_bytes     = 64;
+   static constexpr std::size_t words_per_block = block_bytes / sizeof(uint64_t);
+   static constexpr std::size_t bits_per_block  = block_bytes * bits_per_char;
+   static constexpr std::size_t max_hash_count  = 32;
+   static constexpr std::size_t batch_size      = 16;
+   /// largest table accepted by raw::unpack, which may see untrusted input
+   static constexpr std::size_t max_unpack_block_count = MAX_SIZE_OF_BYTE_ARRAYS / block_bytes;
+
+   template<typename T>
+   struct block_allocator
+   {
+      typedef T value_type;
+
+      block_allocator() = default;
+      template<typename U>
+      block_allocator(const block_allocator<U>&) {}
+
+      T* allocate(std::size_t n)
+      {
+         return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(block_bytes)));
+      }
+
+      void deallocate(T* p, std::size_t)
+      {
+         ::operator delete(p, std::align_val_t(block_bytes));
+      }
+
+      template<typename U>
+      bool operator == (const block_allocator<U>&) const { return true; }
+      template<typename U>
+      bool operator != (const block_allocator<U>&) const { return false; }
+   };
+
+   typedef std::vector<uint64_t, block_allocator<uint64_t>> table_type;
+
+   blocked_bloom_filter() = default;
+
+   /**
+    *  @param p parameters after compute_optimal_parameters(); table_size is rounded up to a whole number of blocks
+    *           and number_of_hashes is capped at max_hash_count
+    */
+   blocked_bloom_filter(const bloom_parameters& p)
+   : salt_count_(std::min<std::size_t>(std::max(p.optimal_parameters.number_of_hashes, 1u), max_hash_count)),
+     block_count_(std::min<unsigned long long int>(std::max<unsigned long long int>((p.optimal_parameters.table_size + bits_per_block - 1) / bits_per_block, 1),
+                                                   std::numeric_limits<uint32_t>::max())),
+     projected_element_count_(p.projected_element_count),
+     random_seed_((p.random_seed * 0xA5A5A5A5) + 1),
+     desired_false_positive_probability_(p.false_positive_probability)
+   {
+      bit_table_.resize(static_cast<std::size_t>(block_count_ * words_per_block), 0);
+   }
+
+   inline bool operator == (const blocked_bloom_filter& f) const
+   {
+      return (salt_count_                         == f.salt_count_)                         &&
+             (block_count_                        == f.block_count_)                        &&
+             (projected_element_count_            == f.projected_element_count_)            &&
+             (inserted_element_count_             == f.inserted_element_count_)             &&
+             (random_seed_                        == f.random_seed_)                        &&
+             (desired_false_positive_probability_ == f.desired_false_positive_probability_) &&
+             (bit_table_                          == f.bit_table_);
+   }
+
+   inline bool operator != (const blocked_bloom_filter& f) const
+   {
+      return !operator==(f);
+   }
+
+   inline bool operator!() const
+   {
+      return (0 == block_count_);
+   }
+
+   inline void clear()
+   {
+      std::fill(bit_table_.begin(), bit_table_.end(), 0);
+      inserted_element_count_ = 0;
+   }
+
+   inline void insert(const unsigned char* key_begin, const std::size_t& length)
+   {
+      insert_hash(hash(key_begin, length));
+   }
+
+   template<typename T>
+   inline void insert(const T& t)
+   {
+      // Note: T must be a C++ POD type.
+      insert(reinterpret_cast<const unsigned char*>(&t), sizeof(T));
+   }
+
+   inline void insert(const std::string& key)
+   {
+      insert(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+   }
+
+   inline void insert(const char* data, const std::size_t& length)
+   {
+      insert(reinterpret_cast<const unsigned char*>(data), length);
+   }
+
+   template<typename InputIterator>
+   inline void insert_many(InputIterator begin, const InputIterator end)
+   {
+      uint64_t hashes[batch_size];
+      while (end != begin)
+      {
+         std::size_t n = 0;
+         for (; n < batch_size && end != begin; ++n, ++begin)
+         {
+            hashes[n] = hash(*begin);
+            prefetch(hashes[n]);
+         }
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            insert_hash(hashes[i]);
+         }
+      }
+   }
+
+   inline bool contains(const unsigned char* key_begin, const std::size_t length) const
+   {
+      return contains_hash(hash(key_begin, length));
+   }
+
+   template<typename T>
+   inline bool contains(const T& t) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(&t), static_cast<std::size_t>(sizeof(T)));
+   }
+
+   inline bool contains(const std::string& key) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+   }
+
+   inline bool contains(const char* data, const std::size_t& length) const
+   {
+      return contains(reinterpret_cast<const unsigned char*>(data), length);
+   }
+
+   /**
+    *  Writes one bool per key in [begin, end) to out.
+    *  @return the output iterator past the last written result
+    */
+   template<typename InputIterator, typename OutputIterator>
+   inline OutputIterator contains_many(InputIterator begin, const InputIterator end, OutputIterator out) const
+   {
+      uint64_t hashes[batch_size];
+      while (end != begin)
+      {
+         std::size_t n = 0;
+         for (; n < batch_size && end != begin; ++n, ++begin)
+         {
+            hashes[n] = hash(*begin);
+            prefetch(hashes[n]);
+         }
+         for (std::size_t i = 0; i < n; ++i)
+         {
+            *out++ = contains_hash(hashes[i]);
+         }
+      }
+      return out;
+   }
+
+   /// size of the table in bits
+   inline unsigned long long int size() const
+   {
+      return block_count_ * bits_per_block;
+   }
+
+   inline std::size_t element_count() const
+   {
+      return inserted_element_count_;
+   }
+
+   inline std::size_t hash_count() const
+   {
+      return salt_count_;
+   }
+
+   inline blocked_bloom_filter& operator |= (const blocked_bloom_filter& f)
+   {
+      /* union */
+      if (
+          (salt_count_  == f.salt_count_)  &&
+          (block_count_ == f.block_count_) &&
+          (random_seed_ == f.random_seed_)
+         )
+      {
+         for (std::size_t i = 0; i < bit_table_.size(); ++i)
+         {
+            bit_table_[i] |= f.bit_table_[i];
+         }
+      }
+      return *this;
+   }
+
+   inline const uint64_t* table() const
+   {
+      return bit_table_.data();
+   }
+
+protected:
+
+   template<typename T>
+   inline uint64_t hash(const T& t) const
+   {
+      return hash(reinterpret_cast<const unsigned char*>(&t), sizeof(T));
+   }
+
+   inline uint64_t hash(const std::string& key) const
+   {
+      return hash(reinterpret_cast<const unsigned char*>(key.data()), key.size());
+   }
+
+   inline uint64_t hash(const unsigned char* key_begin, std::size_t length) const
+   {
+      // murmur3 finalizer so the seed affects every bit of the result
+      uint64_t h = city_hash64(reinterpret_cast<const char*>(key_begin), length) ^ random_seed_;
+      h ^= h >> 33;
+      h *= 0xFF51AFD7ED558CCDULL;
+      h ^= h >> 33;
+      h *= 0xC4CEB9FE1A85EC53ULL;
+      h ^= h >> 33;
+      return h;
+   }
+
+   /// maps the upper 32 bits of the hash onto [0, block_count_) without a division
+   inline const uint64_t* block_for(uint64_t h) const
+   {
+      return bit_table_.data() + ((((h >> 32) * block_count_) >> 32) * words_per_block);
+   }
+
+   inline uint64_t* block_for(uint64_t h)
+   {
+      return bit_table_.data() + ((((h >> 32) * block_count_) >> 32) * words_per_block);
+   }
+
+   inline void prefetch(uint64_t h) const
+   {
+#if defined(__GNUC__)
+      __builtin_prefetch(block_for(h));
+#endif
+   }
+
+   /// sets the salt_count_ bits of the key within a block, double hashing on the lower half of the hash
+   inline void compute_mask(uint64_t h, uint64_t (&mask)[words_per_block]) const
+   {
+      const uint32_t h1 = static_cast<uint32_t>(h);
+      const uint32_t h2 = static_cast<uint32_t>((h * 0x9E3779B97F4A7C15ULL) >> 32) | 1;
+      std::fill_n(mask, words_per_block, 0);
+      for (std::size_t i = 0; i < salt_count_; ++i)
+      {
+         const uint32_t bit = (h1 + static_cast<uint32_t>(i) * h2) & (bits_per_block - 1);
+         mask[bit >> 6] |= 1ULL << (bit & 63);
+      }
+   }
+
+   inline void insert_hash(uint64_t h)
+   {
+      FC_ASSERT(!bit_table_.empty(), "insert into an empty blocked_bloom_filter");
+      uint64_t mask[words_per_block];
+      compute_mask(h, mask);
+      uint64_t* block = block_for(h);
+      for (std::size_t i = 0; i < words_per_block; ++i)
+      {
+         block[i] |= mask[i];
+      }
+      ++inserted_element_count_;
+   }
+
+   inline bool contains_hash(uint64_t h) const
+   {
+      if (bit_table_.empty())
+      {
+         return false;
+      }
+      alignas(block_bytes) uint64_t mask[words_per_block];
+      compute_mask(h, mask);
+      const uint64_t* block = block_for(h);
+#if defined(__AVX2__)
+      const __m256i* b = reinterpret_cast<const __m256i*>(block);
+      const __m256i* m = reinterpret_cast<const __m256i*>(mask);
+      return _mm256_testc_si256(_mm256_load_si256(b),     _mm256_load_si256(m)) &
+             _mm256_testc_si256(_mm256_load_si256(b + 1), _mm256_load_si256(m + 1));
+#elif defined(__SSE4_1__)
+      const __m128i* b = reinterpret_cast<const __m128i*>(block);
+      const __m128i* m = reinterpret_cast<const __m128i*>(mask);
+      return _mm_testc_si128(_mm_load_si128(b),     _mm_load_si128(m))     &
+             _mm_testc_si128(_mm_load_si128(b + 1), _mm_load_si128(m + 1)) &
+             _mm_testc_si128(_mm_load_si128(b + 2), _mm_load_si128(m + 2)) &
+             _mm_testc_si128(_mm_load_si128(b + 3), _mm_load_si128(m + 3));
+#else
+      uint64_t missing = 0;
+      for (std::size_t i = 0; i < words_per_block; ++i)
+      {
+         missing |= mask[i] & ~block[i];
+      }
+      return 0 == missing;
+#endif
+   }
+
+public:
+   table_type              bit_table_;
+   unsigned int            salt_count_ = 0;
+   unsigned long long int  block_count_ = 0;
+   unsigned long long int  projected_element_count_ = 0;
+   unsigned int            inserted_element_count_ = 0;
+   unsigned long long int  random_seed_ = 0;
+   double                  desired_false_positive_probability_ = 0.0;
+};
+
+namespace raw
+{
+   /// the table is packed in the same format as a std::vector<uint64_t>
+   template<typename Stream>
+   inline void pack( Stream& s, const blocked_bloom_filter& f )
+   {
+      fc::raw::pack( s, f.salt_count_ );
+      fc::raw::pack( s, f.block_count_ );
+      fc::raw::pack( s, f.projected_element_count_ );
+      fc::raw::pack( s, f.inserted_element_count_ );
+      fc::raw::pack( s, f.random_seed_ );
+      fc::raw::pack( s, f.desired_false_positive_probability_ );
+      fc::raw::pack( s, unsigned_int( (uint32_t)f.bit_table_.size() ) );
+      s.write( reinterpret_cast<const char*>( f.bit_table_.data() ), f.bit_table_.size() * sizeof(uint64_t) );
+   }
+
+   template<typename Stream>
+   inline void unpack( Stream& s, blocked_bloom_filter& f )
+   {
+      fc::raw::unpack( s, f.salt_count_ );
+      fc::raw::unpack( s, f.block_count_ );
+      fc::raw::unpack( s, f.projected_element_count_ );
+      fc::raw::unpack( s, f.inserted_element_count_ );
+      fc::raw::unpack( s, f.random_seed_ );
+      fc::raw::unpack( s, f.desired_false_positive_probability_ );
+      FC_ASSERT( f.salt_count_ >= 1 && f.salt_count_ <= blocked_bloom_filter::max_hash_count, "invalid blocked_bloom_filter hash count" );
+      FC_ASSERT( f.block_count_ >= 1 && f.block_count_ <= blocked_bloom_filter::max_unpack_block_count, "invalid blocked_bloom_filter block count" );
+      unsigned_int size; fc::raw::unpack( s, size );
+      FC_ASSERT( size.value == f.block_count_ * blocked_bloom_filter::words_per_block, "blocked_bloom_filter table size mismatch" );
+      f.bit_table_.resize( size.value );
+      s.read( reinterpret_cast<char*>( f.bit_table_.data() ), f.bit_table_.size() * sizeof(uint64_t) );
+   }
+} // namespace raw
+
 
 } // namespace fc
 
@@ -4,6 +4,9 @@
 #include <fc/io/datastream.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/io/persistence_util.hpp>
+#include <fc/crypto/crc.hpp>
+#include <fc/parallel_for.hpp>
 #include <fstream>
 
 namespace fc {
@@ -69,6 +72,167 @@ namespace fc {
          }
       }
 
+      static constexpr size_t default_chunk_items = 64*1024;
+
+      /**
+       * Chunked alternative to write(): items are packed into per-chunk buffers on num_threads threads and
+       * written behind a persistence_util chunk table holding each chunk's offset, size, item count and crc32c.
+       * Must be read back with read_chunked().
+       */
+      void write_chunked(fc::cfile& dat_content, size_t num_threads = std::thread::hardware_concurrency(),
+                         size_t chunk_items = default_chunk_items) const {
+         FC_ASSERT( chunk_items > 0, "chunk_items must be positive" );
+         using value_type = typename ContainerType::value_type;
+
+         std::vector<const value_type*> items;
+         items.reserve(_index.size());
+         for (const auto& item : _index)
+            items.push_back(&item);
+
+         const size_t num_chunks = (items.size() + chunk_items - 1) / chunk_items;
+         std::vector<std::vector<char>> buffers(num_chunks);
+         persistence_util::chunk_table table;
+         table.total_items = items.size();
+         table.chunks.resize(num_chunks);
+
+         detail::parallel_for(num_chunks, num_threads, [&](size_t c) {
+            const size_t begin = c * chunk_items;
+            const size_t end = std::min(begin + chunk_items, items.size());
+            size_t size = 0;
+            for (size_t i = begin; i < end; ++i)
+               size += fc::raw::pack_size(*items[i]);
+
+            auto& buf = buffers[c];
+            buf.resize(size);
+            fc::datastream<char*> ds(buf.data(), buf.size());
+            for (size_t i = begin; i < end; ++i)
+               fc::raw::pack(ds, *items[i]);
+
+            auto& info = table.chunks[c];
+            info.size = size;
+            info.items = end - begin;
+            info.crc = fc::crc32c(buf.data(), buf.size());
+         });
+
+         uint64_t offset = 0;
+         for (auto& info : table.chunks) {
+            info.offset = offset;
+            offset += info.size;
+         }
+
+         persistence_util::write_chunk_table(dat_content, table);
+         for (const auto& buf : buffers)
+            dat_content.write(buf.data(), buf.size());
+      }
+
+      /**
+       * Read a section written by write_chunked(). Chunks are read and crc checked and unpacked on num_threads
+       * threads, up to num_threads chunks at a time; insertion stays in file order and stops once max_memory is
+       * reached, as in read(). A wave only takes the chunks expected to fit in the remaining budget, going by the
+       * memory per packed byte of the chunks inserted so far. The first chunk, and any chunk that may cross
+       * max_memory, is unpacked item by item like read(), so no more than one item is unpacked past the budget.
+       * The file is left positioned after the section either way.
+       * returns true if entire persisted tracked_storage was read
+       */
+      bool read_chunked(fc::cfile& dat_content, size_t max_memory,
+                        size_t num_threads = std::thread::hardware_concurrency()) {
+         using value_type = typename ContainerType::value_type;
+
+         const auto table = persistence_util::read_chunk_table(dat_content);
+         const size_t data_start = dat_content.tellp();
+         const size_t wave = std::max<size_t>(1, num_threads);
+         const auto& chunks = table.chunks;
+
+         auto read_chunk = [&](size_t c) {
+            std::vector<char> buf(chunks[c].size);
+            dat_content.read(buf.data(), buf.size());
+            return buf;
+         };
+         auto check_chunk = [&](size_t c, const std::vector<char>& buf) {
+            const uint32_t crc = fc::crc32c(buf.data(), buf.size());
+            if (crc != chunks[c].crc) {
+               FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk ${c} failed crc check: ${crc} != ${expected}",
+                                  ("c", c)("crc", crc)("expected", chunks[c].crc));
+            }
+         };
+         auto check_consumed = [&](size_t c, const fc::datastream<const char*>& ds) {
+            if (ds.remaining() != 0) {
+               FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk ${c} has ${r} bytes left after its ${i} items",
+                                  ("c", c)("r", ds.remaining())("i", chunks[c].items));
+            }
+         };
+
+         const size_t initial_memory = memory_size();
+         size_t bytes_inserted = 0; // packed size of the chunks inserted so far
+
+         bool complete = true;
+         size_t first = 0;
+         while (first < chunks.size() && complete) {
+            // chunks expected to fit in what is left of max_memory are unpacked together
+            size_t last = first;
+            if (bytes_inserted > 0 && memory_size() < max_memory) {
+               const double memory_per_byte = double(memory_size() - initial_memory) / bytes_inserted;
+               double budget = double(max_memory - memory_size());
+               while (last < chunks.size() && last - first < wave) {
+                  budget -= memory_per_byte * chunks[last].size;
+                  if (budget < 0)
+                     break;
+                  ++last;
+               }
+            }
+
+            if (last == first) {
+               const auto buf = read_chunk(first);
+               check_chunk(first, buf);
+               fc::datastream<const char*> ds(buf.data(), buf.size());
+               for (uint64_t i = 0; i < chunks[first].items; ++i) {
+                  if (memory_size() >= max_memory) {
+                     complete = false;
+                     break;
+                  }
+                  value_type v;
+                  fc::raw::unpack(ds, v);
+                  insert(std::move(v));
+               }
+               if (complete)
+                  check_consumed(first, ds);
+               bytes_inserted += chunks[first].size;
+               ++first;
+               continue;
+            }
+
+            std::vector<std::vector<char>> buffers(last - first);
+            for (size_t c = first; c < last; ++c)
+               buffers[c - first] = read_chunk(c);
+
+            std::vector<std::vector<value_type>> values(last - first);
+            detail::parallel_for(last - first, num_threads, [&](size_t i) {
+               const auto& buf = buffers[i];
+               check_chunk(first + i, buf);
+               fc::datastream<const char*> ds(buf.data(), buf.size());
+               values[i].resize(chunks[first + i].items);
+               for (auto& v : values[i])
+                  fc::raw::unpack(ds, v);
+               check_consumed(first + i, ds);
+            });
+
+            for (size_t i = 0; i < values.size() && complete; ++i) {
+               for (auto& v : values[i]) {
+                  if (memory_size() >= max_memory) {
+                     complete = false;
+                     break;
+                  }
+                  insert(std::move(v));
+               }
+               bytes_inserted += chunks[first + i].size;
+            }
+            first = last;
+         }
+
+         dat_content.seek(data_start + table.data_size());
+         return complete;
+      }
+
       std::pair<typename primary_index_type::iterator, bool> insert(typename ContainerType::value_type obj) {
          const auto size = tracked::memory_size(obj);
          auto result = _index.insert(std::move(obj));
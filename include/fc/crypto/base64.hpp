@@ -11,4 +11,6 @@ std::string base64url_encode(unsigned char const* bytes_to_encode, unsigned int
 inline std::string base64url_encode(char const* bytes_to_encode, unsigned int in_len) { return base64url_encode( (unsigned char const*)bytes_to_encode, in_len); }
 std::string base64url_encode( const std::string& enc );
 std::string base64url_decode( const std::string& encoded_string);
+/// decodes into out without allocating, writing at most out_size bytes; returns the full decoded size
+size_t base64url_decode( const char* encoded_string, size_t len, char* out, size_t out_size );
 }  // namespace fc
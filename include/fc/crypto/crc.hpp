@@ -0,0 +1,10 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+namespace fc {
+
+   /// CRC-32C (Castagnoli) of len bytes; pass a previous result as crc to continue a running checksum
+   uint32_t crc32c( const char* data, size_t len, uint32_t crc = 0 );
+
+}
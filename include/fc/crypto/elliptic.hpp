@@ -15,8 +15,11 @@ namespace fc {
     {
       class public_key_impl;
       class private_key_impl;
+      class prepared_public_key_impl;
     }
 
+    class prepared_public_key;
+
     typedef fc::sha256                  blind_factor_type;
     typedef fc::array<char,33>          commitment_type;
     typedef fc::array<char,33>          public_key_data;
@@ -75,6 +78,7 @@ namespace fc {
 
         private:
           friend class private_key;
+          friend class prepared_public_key;
           static public_key from_key_data( const public_key_data& v );
           static bool is_canonical( const compact_signature& c );
           fc::fwd<detail::public_key_impl,33> my;
@@ -116,6 +120,7 @@ namespace fc {
             *  key and this private key.
             */
            fc::sha512 get_shared_secret( const public_key& pub )const;
+           fc::sha512 get_shared_secret( const prepared_public_key& pub )const;
 
 //           signature         sign( const fc::sha256& digest )const;
            compact_signature sign_compact( const fc::sha256& digest, bool require_canonical = true )const;
@@ -144,6 +149,39 @@ namespace fc {
            fc::fwd<detail::private_key_impl,32> my;
     };
 
+    /**
+     *  @class prepared_public_key
+     *  @brief a public key that has already been parsed into a curve point
+     *
+     *  Keys that are used over and over, such as producer keys, can be prepared once so that verifying
+     *  signatures and deriving shared secrets no longer decompresses the key on every call.
+     */
+    class prepared_public_key
+    {
+        public:
+           prepared_public_key();
+           explicit prepared_public_key( const public_key& k );
+           prepared_public_key( const prepared_public_key& k );
+           ~prepared_public_key();
+
+           prepared_public_key& operator=( const prepared_public_key& k );
+
+           const public_key& get_public_key()const { return _key; }
+
+           /**
+            *  Checks that sig was made by this key without recovering a key from it. High s values are accepted,
+            *  as they are by recovery, but the recovery id is NOT checked: a signature whose recovery id does not
+            *  match still verifies, where public_key( sig, digest ) == key would be false. This is therefore not
+            *  a drop-in replacement for recover-and-compare and must not be used where consensus depends on it.
+            */
+           bool verify_ignoring_recovery_id( const fc::sha256& digest, const compact_signature& sig, bool check_canonical = true )const;
+
+        private:
+           friend class private_key;
+           public_key                                     _key;
+           fc::fwd<detail::prepared_public_key_impl,64>   my;
+    };
+
       /**
        * Shims
        */
@@ -25,6 +25,19 @@ namespace fc {
 
     int ECDSA_SIG_recover_key_GFp(EC_KEY *eckey, ECDSA_SIG *ecsig, const unsigned char *msg, int msglen, int recid, int check);
 
+    /**
+     *  Recovers the compressed public key of a compact signature without constructing a public_key. Unless fc is
+     *  built with R1_RECOVERY_IMPL=generic, the curve, big numbers and points used are allocated once per thread.
+     *  @param enforce_low_s reject signatures with an s value above half the order, as public_key does
+     */
+    public_key_data recover_public_key_data( const compact_signature& c, const fc::sha256& digest, bool enforce_low_s = true );
+
+    /**
+     *  Recovers the public keys of many (signature, digest) pairs, sharing the per-thread recovery context.
+     *  Throws on the first signature that cannot be recovered.
+     */
+    std::vector<public_key_data> recover_public_key_data_batch( const std::vector<std::pair<compact_signature, fc::sha256>>& sigs );
+
     /**
      *  @class public_key
      *  @brief contains only the public point of an elliptic curve key.
@@ -146,7 +159,7 @@ namespace fc {
         using crypto::shim<compact_signature>::shim;
 
         public_key_type recover(const sha256& digest, bool check_canonical) const {
-           return public_key_type(public_key(_data, digest, check_canonical).serialize());
+           return public_key_type(recover_public_key_data(_data, digest));
         }
      };
 
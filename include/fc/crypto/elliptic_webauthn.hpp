@@ -112,6 +112,12 @@ class signature {
       std::string                       client_json;
 };
 
+/**
+ *  Recovers the public keys of many (signature, digest) pairs; the JSON parser and r1 recovery context are
+ *  shared across the batch. Throws on the first signature that cannot be recovered.
+ */
+std::vector<public_key> recover_public_key_batch(const std::vector<std::pair<signature, fc::sha256>>& sigs);
+
 }
 
 template<>
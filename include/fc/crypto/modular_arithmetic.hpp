@@ -1,6 +1,9 @@
 #pragma once
 
+#include <fc/utility.hpp>
+
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <variant>
 
@@ -12,4 +15,43 @@ namespace fc {
     };
 
     std::variant<modular_arithmetic_error, bytes> modexp(const bytes& _base, const bytes& _exponent, const bytes& _modulus);
+
+    namespace detail { class modexp_context_impl; }
+
+    /**
+     *  Reusable state for computing many modular exponentiations against the same modulus, e.g. verifying
+     *  a batch of RSA signatures under one public key. The modulus is imported once and the big integer
+     *  temporaries are kept across calls, so repeated calls do not allocate beyond the output buffer.
+     *
+     *  Results are identical to fc::modexp. When constructed with constant_time set and the modulus is odd,
+     *  exponentiation uses a side-channel resistant ladder; even moduli fall back to the regular path.
+     *
+     *  If a yield function is supplied, long exponents are processed in fixed size chunks and the yield
+     *  function is called between chunks so that callers can enforce deadlines. Chunk digits are kept
+     *  nonzero so that the constant time ladder covers every chunk.
+     *
+     *  Not thread safe; use one context per thread.
+     */
+    class modexp_context {
+    public:
+        explicit modexp_context(const bytes& _modulus, bool constant_time = false);
+        ~modexp_context();
+
+        modexp_context(const modexp_context&) = delete;
+        modexp_context& operator=(const modexp_context&) = delete;
+
+        std::variant<modular_arithmetic_error, bytes> modexp(const bytes& _base, const bytes& _exponent,
+                                                             const yield_function_t& yield = yield_function_t());
+
+        /// raises every base to the same exponent; the yield function is also called between bases
+        std::variant<modular_arithmetic_error, std::vector<bytes>> modexp_batch(const std::vector<bytes>& _bases,
+                                                                                const bytes& _exponent,
+                                                                                const yield_function_t& yield = yield_function_t());
+
+        /// exponents longer than this many bits are split into chunks of this size when a yield function is supplied
+        static constexpr size_t yield_chunk_bits = 256;
+
+    private:
+        std::unique_ptr<detail::modexp_context_impl> my;
+    };
 }
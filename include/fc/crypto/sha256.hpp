@@ -108,6 +108,10 @@ class sha256
 
   uint64_t hash64(const char* buf, size_t len);    
 
+  namespace raw {
+    template<> struct static_pack_size<sha256> : std::integral_constant<size_t, sizeof(sha256)> {};
+  }
+
 } // fc
 
 namespace std
@@ -64,6 +64,15 @@ namespace fc
             code_value = unspecified_exception_code
          };
 
+         /**
+          *  A name or what string with static storage duration, e.g. a literal, which the exception references
+          *  instead of copying. Used by FC_DECLARE_DERIVED_EXCEPTION.
+          */
+         struct static_text {
+            explicit constexpr static_text( const char* s ):str(s){}
+            const char* str;
+         };
+
          exception( int64_t code = unspecified_exception_code,
                     const std::string& name_value = "exception",
                     const std::string& what_value = "unspecified");
@@ -77,6 +86,9 @@ namespace fc
                     int64_t code = unspecified_exception_code,
                     const std::string& name_value = "exception",
                     const std::string& what_value = "unspecified");
+         exception( int64_t code, static_text name_value, static_text what_value );
+         exception( log_message&&, int64_t code, static_text name_value, static_text what_value );
+         exception( log_messages&&, int64_t code, static_text name_value, static_text what_value );
          exception( const exception& e );
          exception( exception&& e );
          virtual ~exception();
@@ -271,17 +283,23 @@ namespace fc
        :BASE( std::move(m), code, name_value, what_value ){}\
        explicit TYPE( const fc::log_messages& m, int64_t code, const std::string& name_value, const std::string& what_value )\
        :BASE( m, code, name_value, what_value ){}\
+       explicit TYPE( int64_t code, fc::exception::static_text name_value, fc::exception::static_text what_value ) \
+       :BASE( code, name_value, what_value ){} \
+       explicit TYPE( fc::log_message&& m, int64_t code, fc::exception::static_text name_value, fc::exception::static_text what_value ) \
+       :BASE( std::move(m), code, name_value, what_value ){} \
+       explicit TYPE( fc::log_messages&& m, int64_t code, fc::exception::static_text name_value, fc::exception::static_text what_value ) \
+       :BASE( std::move(m), code, name_value, what_value ){} \
        TYPE( const std::string& what_value, const fc::log_messages& m ) \
        :BASE( m, CODE, BOOST_PP_STRINGIZE(TYPE), what_value ){} \
        TYPE( fc::log_message&& m ) \
-       :BASE( fc::move(m), CODE, BOOST_PP_STRINGIZE(TYPE), WHAT ){}\
+       :BASE( fc::move(m), CODE, fc::exception::static_text( BOOST_PP_STRINGIZE(TYPE) ), fc::exception::static_text( WHAT ) ){}\
        TYPE( fc::log_messages msgs ) \
-       :BASE( fc::move( msgs ), CODE, BOOST_PP_STRINGIZE(TYPE), WHAT ) {} \
+       :BASE( fc::move( msgs ), CODE, fc::exception::static_text( BOOST_PP_STRINGIZE(TYPE) ), fc::exception::static_text( WHAT ) ) {} \
        TYPE( const TYPE& c ) \
        :BASE(c){} \
        TYPE( const BASE& c ) \
        :BASE(c){} \
-       TYPE():BASE(CODE, BOOST_PP_STRINGIZE(TYPE), WHAT){}\
+       TYPE():BASE(CODE, fc::exception::static_text( BOOST_PP_STRINGIZE(TYPE) ), fc::exception::static_text( WHAT )){}\
        \
        virtual std::shared_ptr<fc::exception> dynamic_copy_exception()const\
        { return std::make_shared<TYPE>( *this ); } \
@@ -15,6 +15,15 @@ namespace fc {
     read_write
   };
 
+  /// access pattern hints for mapped_region::advise
+  enum advice_t {
+    advice_normal,
+    advice_sequential,
+    advice_random,
+    advice_willneed,
+    advice_dontneed
+  };
+
   class file_mapping {
     public:
       file_mapping( const char* file, mode_t );
@@ -34,6 +43,8 @@ namespace fc {
       mapped_region( const file_mapping& fm, mode_t m );
       ~mapped_region();
       void  flush();
+      /// returns false if the hint is not supported on this platform
+      bool  advise( advice_t a );
       void* get_address()const;
       size_t get_size()const;
     private:
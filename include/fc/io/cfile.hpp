@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/filesystem.hpp>
 #include <fc/io/datastream.hpp>
+#include <fc/crypto/crc.hpp>
 #include <cstdio>
 #include <ios>
 #include <fcntl.h>
@@ -22,7 +23,12 @@ namespace detail {
    using unique_file = std::unique_ptr<FILE, decltype( &fclose )>;
 }
 
-class cfile_datastream;
+class cfile;
+
+template <typename File>
+class basic_cfile_datastream;
+
+using cfile_datastream = basic_cfile_datastream<cfile>;
 
 /**
  * Wrapper for c-file access that provides a similar interface as fstream without all the overhead of std streams.
@@ -76,6 +82,22 @@ public:
       _open = true;
    }
 
+#ifndef _WIN32
+   /// takes ownership of an already open file descriptor, e.g. one created with O_TMPFILE
+   void open_fd( int fd, const char* mode ) {
+      _file.reset( fdopen( fd, mode ) );
+      if( !_file ) {
+         ::close( fd );
+         throw std::ios_base::failure( "cfile unable to fdopen: " +  _file_path.generic_string() + " in mode: " + std::string( mode ) );
+      }
+      struct stat st;
+      _file_blk_size = 4096;
+      if( fstat(fileno(), &st) == 0 )
+         _file_blk_size = st.st_blksize;
+      _open = true;
+   }
+#endif
+
    size_t tellp() const {
       long result = ftell( _file.get() );
       if (result == -1)
@@ -130,8 +152,22 @@ public:
          throw std::ios_base::failure( "cfile: " + _file_path.generic_string() +
                                        " unable to write " + std::to_string( n ) + " bytes; only wrote " + std::to_string( result ) );
       }
+      if( _track_writes ) {
+         _write_crc = fc::crc32c( d, n, _write_crc );
+         _write_size += n;
+      }
+   }
+
+   /// starts a running crc32c over all bytes passed to write() from here on; only meaningful for sequential writes
+   void track_writes() {
+      _track_writes = true;
+      _write_crc = 0;
+      _write_size = 0;
    }
 
+   uint32_t written_crc() const { return _write_crc; }
+   size_t written_size() const { return _write_size; }
+
    void flush() {
       if( 0 != fflush( _file.get() ) ) {
          int err = ferror( _file.get() );
@@ -215,16 +251,20 @@ private:
    fc::path              _file_path;
    size_t                _file_blk_size = 4096;
    detail::unique_file   _file;
+   bool                  _track_writes = false;
+   uint32_t              _write_crc = 0;
+   size_t                _write_size = 0;
 };
 
 /*
- *  @brief datastream adapter that adapts cfile for use with fc unpack
+ *  @brief datastream adapter that adapts cfile (or fd_file) for use with fc unpack
  *
  *  This class supports unpack functionality but not pack.
  */
-class cfile_datastream {
+template <typename File>
+class basic_cfile_datastream {
 public:
-   explicit cfile_datastream( cfile& cf ) : cf(cf) {}
+   explicit basic_cfile_datastream( File& cf ) : cf(cf) {}
 
    void skip( size_t s ) {
       std::vector<char> d( s );
@@ -243,7 +283,7 @@ public:
    size_t tellp() const { return cf.tellp(); }
 
  private:
-   cfile& cf;
+   File& cf;
 };
 
 inline cfile_datastream cfile::create_datastream() {
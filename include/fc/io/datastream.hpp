@@ -81,6 +81,64 @@ class datastream<T, std::enable_if_t<std::is_same_v<T, char*> || std::is_same_v<
       T _end;
 };
 
+/// true for datastreams over a contiguous range of memory, i.e. ones that provide pos() and remaining()
+template<typename Stream>
+constexpr bool is_contiguous_datastream = false;
+
+template<typename T>
+constexpr bool is_contiguous_datastream<datastream<T>> = std::is_pointer_v<T>;
+
+/**
+ *  Read-only stream over bytes whose length the caller has already validated, e.g. against
+ *  fc::raw::static_pack_size. read(), get() and skip() do no bounds checking at all.
+ */
+class unchecked_datastream {
+   public:
+      explicit unchecked_datastream( const char* start )
+      :_start(start),_pos(start){}
+
+      inline void skip( size_t s ) { _pos += s; }
+      inline bool read( char* d, size_t s ) {
+        memcpy( d, _pos, s );
+        _pos += s;
+        return true;
+      }
+
+      inline bool get( unsigned char& c ) { c = *_pos++; return true; }
+      inline bool get( char& c )          { c = *_pos++; return true; }
+
+      const char*   pos()const        { return _pos;          }
+      inline bool   valid()const      { return true;          }
+      inline size_t tellp()const      { return _pos - _start; }
+   private:
+      const char* _start;
+      const char* _pos;
+};
+
+/**
+ *  Write-only counterpart of unchecked_datastream; write() and put() do no bounds checking at all.
+ */
+class unchecked_write_datastream {
+   public:
+      explicit unchecked_write_datastream( char* start )
+      :_start(start),_pos(start){}
+
+      inline void skip( size_t s ) { _pos += s; }
+      inline bool write( const char* d, size_t s ) {
+        memcpy( _pos, d, s );
+        _pos += s;
+        return true;
+      }
+      inline bool put( char c ) { *_pos++ = c; return true; }
+
+      char*         pos()const        { return _pos;          }
+      inline bool   valid()const      { return true;          }
+      inline size_t tellp()const      { return _pos - _start; }
+   private:
+      char* _start;
+      char* _pos;
+};
+
 template<>
 class datastream<size_t, void> {
    public:
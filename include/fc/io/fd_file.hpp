@@ -0,0 +1,473 @@
+#pragma once
+#include <fc/io/cfile.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <unistd.h>
+
+namespace fc {
+
+namespace detail {
+   using aligned_buffer = std::unique_ptr<char, decltype( &free )>;
+}
+
+class fd_file;
+
+using fd_file_datastream = basic_cfile_datastream<fd_file>;
+
+/**
+ * File access on a raw file descriptor with the same interface as cfile, plus positional I/O.
+ *
+ * Unlike cfile there is no stdio buffer or stdio lock: reads are issued as pread at the tracked position and
+ * pread_at/pwrite_at do not move it, so random reads are a single system call. Writes are collected in an
+ * aligned buffer whose size is chosen with set_write_buffer_size(); a size of 0 disables write buffering.
+ * Small reads are served from a read buffer sized with set_read_buffer_size() so that byte-wise unpacking
+ * through fd_file_datastream does not issue one system call per byte.
+ *
+ * If use_direct_io() is set before open(), full aligned blocks of the write buffer are written through a
+ * second descriptor opened with O_DIRECT, bypassing the page cache. Filesystems that reject O_DIRECT silently
+ * fall back to buffered writes. Reads always go through the page cache.
+ *
+ * std::ios_base::failure exception thrown for errors.
+ */
+class fd_file {
+public:
+   fd_file() = default;
+   fd_file( const fd_file& ) = delete;
+   fd_file& operator=( const fd_file& ) = delete;
+
+   fd_file( fd_file&& o ) noexcept { *this = std::move( o ); }
+   fd_file& operator=( fd_file&& o ) noexcept {
+      if( this != &o ) {
+         close_noexcept();
+         _open = std::exchange( o._open, false );
+         _append = o._append;
+         _direct = o._direct;
+         _eof = o._eof;
+         _file_path = std::move( o._file_path );
+         _file_blk_size = o._file_blk_size;
+         _fd = std::exchange( o._fd, -1 );
+         _direct_fd = std::exchange( o._direct_fd, -1 );
+         _pos = o._pos;
+         _size = o._size;
+         _wbuf = std::move( o._wbuf );
+         _wbuf_capacity = std::exchange( o._wbuf_capacity, 0 );
+         _wbuf_off = o._wbuf_off;
+         _wbuf_len = std::exchange( o._wbuf_len, 0 );
+         _wbuf_request = o._wbuf_request;
+         _rbuf = std::move( o._rbuf );
+         _rbuf_capacity = std::exchange( o._rbuf_capacity, 0 );
+         _rbuf_off = o._rbuf_off;
+         _rbuf_len = std::exchange( o._rbuf_len, 0 );
+         _rbuf_request = o._rbuf_request;
+      }
+      return *this;
+   }
+
+   ~fd_file() { close_noexcept(); }
+
+   void set_file_path( fc::path file_path ) {
+      _file_path = std::move( file_path );
+   }
+
+   fc::path get_file_path() const {
+      return _file_path;
+   }
+
+   bool is_open() const { return _open; }
+
+   int fileno() const {
+      if( -1 == _fd ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() + " is not open" );
+      }
+      return _fd;
+   }
+
+   static constexpr const char* create_or_update_rw_mode = cfile::create_or_update_rw_mode;
+   static constexpr const char* update_rw_mode = cfile::update_rw_mode;
+   static constexpr const char* truncate_rw_mode = cfile::truncate_rw_mode;
+
+   static constexpr size_t default_write_buffer_size = 64*1024;
+   static constexpr size_t default_read_buffer_size = 4096;
+
+   /// size of the write buffer allocated on open(); 0 writes straight through
+   void set_write_buffer_size( size_t s ) { _wbuf_request = s; }
+   /// size of the read buffer allocated on open(); 0 reads straight through
+   void set_read_buffer_size( size_t s ) { _rbuf_request = s; }
+   /// must be called before open()
+   void use_direct_io( bool d ) { _direct = d; }
+
+   /// @param mode is any mode supported by fopen, interpreted the same way
+   void open( const char* mode ) {
+      close();
+
+      const std::string_view m( mode );
+      const bool plus = m.find( '+' ) != std::string_view::npos;
+      int flags = 0;
+      switch( m.empty() ? '\0' : m[0] ) {
+         case 'r': flags = plus ? O_RDWR : O_RDONLY; break;
+         case 'w': flags = ( plus ? O_RDWR : O_WRONLY ) | O_CREAT | O_TRUNC; break;
+         case 'a': flags = ( plus ? O_RDWR : O_WRONLY ) | O_CREAT; break;
+         default:
+            throw std::ios_base::failure( "fd_file unable to open: " +  _file_path.generic_string() + " in mode: " + std::string( mode ) );
+      }
+      // append is emulated by writing at the tracked size; pwrite ignores the offset on O_APPEND descriptors
+      _append = m[0] == 'a';
+
+      _fd = ::open( _file_path.generic_string().c_str(), flags | O_CLOEXEC, 0666 );
+      if( -1 == _fd ) {
+         throw std::ios_base::failure( "fd_file unable to open: " +  _file_path.generic_string() + " in mode: " + std::string( mode ) +
+                                       ", error: " + std::to_string( errno ) );
+      }
+
+      struct stat st;
+      _file_blk_size = 4096;
+      _size = 0;
+      if( fstat( _fd, &st ) == 0 ) {
+         _file_blk_size = st.st_blksize;
+         _size = st.st_size;
+      }
+      _pos = 0;
+      _eof = false;
+
+#ifdef O_DIRECT
+      if( _direct && ( flags & ( O_WRONLY | O_RDWR ) ) ) {
+         _direct_fd = ::open( _file_path.generic_string().c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC );
+      }
+#endif
+
+      _wbuf_capacity = _wbuf_request;
+      if( _direct_fd != -1 )
+         _wbuf_capacity = std::max( _wbuf_capacity - _wbuf_capacity % _file_blk_size, _file_blk_size );
+      _wbuf = allocate( _wbuf_capacity );
+      _wbuf_len = 0;
+
+      _rbuf_capacity = _rbuf_request;
+      _rbuf = allocate( _rbuf_capacity );
+      _rbuf_len = 0;
+
+      _open = true;
+   }
+
+   size_t tellp() const {
+      return _pos;
+   }
+
+   void seek( long loc ) {
+      if( loc < 0 ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to SEEK_SET to: " + std::to_string(loc) );
+      }
+      _pos = loc;
+      _eof = false;
+   }
+
+   void seek_end( long loc ) {
+      if( loc < 0 && static_cast<size_t>( -loc ) > _size ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to SEEK_END to: " + std::to_string(loc) );
+      }
+      _pos = _size + loc;
+      _eof = false;
+   }
+
+   void skip( long loc ) {
+      if( loc < 0 && static_cast<size_t>( -loc ) > _pos ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to SEEK_CUR to: " + std::to_string(loc) );
+      }
+      _pos += loc;
+      _eof = false;
+   }
+
+   void read( char* d, size_t n ) {
+      size_t result = read_some( d, n );
+      _pos += result;
+      if( result != n ) {
+         _eof = true;
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to read " + std::to_string( n ) + " bytes;"
+                                       " only read " + std::to_string( result ) + ", eof: true" );
+      }
+   }
+
+   void write( const char* d, size_t n ) {
+      if( _append )
+         _pos = _size;
+
+      if( _wbuf_len && _pos != _wbuf_off + _wbuf_len )
+         flush_write_buffer();
+      invalidate_read_buffer( _pos, n );
+
+      if( _wbuf_len + n > _wbuf_capacity ) {
+         flush_write_buffer();
+         if( n >= _wbuf_capacity ) {
+            pwrite_all( _fd, d, n, _pos );
+            _pos += n;
+            _size = std::max( _size, _pos );
+            return;
+         }
+      }
+
+      if( !_wbuf_len )
+         _wbuf_off = _pos;
+      memcpy( _wbuf.get() + _wbuf_len, d, n );
+      _wbuf_len += n;
+      _pos += n;
+      _size = std::max( _size, _pos );
+      if( _wbuf_len == _wbuf_capacity )
+         flush_write_buffer();
+   }
+
+   /// reads n bytes at offset without moving the current position
+   void pread_at( size_t offset, char* d, size_t n ) {
+      flush_write_buffer();
+      size_t result = pread_all( d, n, offset );
+      if( result != n ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to read " + std::to_string( n ) + " bytes at " + std::to_string( offset ) +
+                                       "; only read " + std::to_string( result ) );
+      }
+   }
+
+   /// writes n bytes at offset without moving the current position; bypasses the write buffer
+   void pwrite_at( size_t offset, const char* d, size_t n ) {
+      flush_write_buffer();
+      invalidate_read_buffer( offset, n );
+      pwrite_all( _fd, d, n, offset );
+      _size = std::max( _size, offset + n );
+   }
+
+   void flush() {
+      flush_write_buffer();
+   }
+
+   void sync() {
+      flush_write_buffer();
+      const int fd = fileno();
+      if( -1 == fsync( fd ) ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to sync file, error: " + std::to_string( errno ) );
+      }
+#ifdef __APPLE__
+      if( -1 == fcntl( fd, F_FULLFSYNC ) ) {
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to F_FULLFSYNC file, error: " + std::to_string( errno ) );
+      }
+#endif
+   }
+
+   /// see cfile::punch_hole
+   void punch_hole(size_t begin, size_t end) {
+      flush_write_buffer();
+      if(begin % _file_blk_size) {
+         begin &= ~(_file_blk_size-1);
+         begin += _file_blk_size;
+      }
+      end &= ~(_file_blk_size-1);
+
+      if(begin >= end)
+         return;
+
+      invalidate_read_buffer( begin, end - begin );
+
+      int ret = 0;
+#if defined(__linux__)
+      ret = fallocate(fileno(), FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, begin, end-begin);
+#elif defined(__APPLE__)
+      struct fpunchhole puncher = {0, 0, static_cast<off_t>(begin), static_cast<off_t>(end-begin)};
+      ret = fcntl(fileno(), F_PUNCHHOLE, &puncher);
+#endif
+      if(ret == -1)
+         wlog("Failed to punch hole in file ${f}: ${e}", ("f", _file_path)("e", strerror(errno)));
+   }
+
+   static bool supports_hole_punching() {
+      return cfile::supports_hole_punching();
+   }
+
+   size_t filesystem_block_size() const { return _file_blk_size; }
+
+   /// true if the last read ran past the end of the file
+   bool eof() const { return _eof; }
+
+   int getc() {
+      unsigned char c;
+      if( read_some( reinterpret_cast<char*>( &c ), 1 ) != 1 ) {
+         _eof = true;
+         throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                       " unable to read 1 byte");
+      }
+      ++_pos;
+      return c;
+   }
+
+   void close() {
+      if( _open )
+         flush_write_buffer();
+      close_noexcept();
+   }
+
+   boost::interprocess::mapping_handle_t get_mapping_handle() const {
+      return {fileno(), false};
+   }
+
+   fd_file_datastream create_datastream();
+
+private:
+   static detail::aligned_buffer allocate( size_t s ) {
+      void* p = nullptr;
+      if( s && posix_memalign( &p, 4096, s ) != 0 )
+         throw std::bad_alloc();
+      return detail::aligned_buffer( static_cast<char*>( p ), &free );
+   }
+
+   void close_noexcept() noexcept {
+      if( _open && _wbuf_len ) {
+         try { flush_write_buffer(); } catch( ... ) {}
+      }
+      if( _direct_fd != -1 )
+         ::close( _direct_fd );
+      if( _fd != -1 )
+         ::close( _fd );
+      _fd = _direct_fd = -1;
+      _wbuf_len = _rbuf_len = 0;
+      _open = false;
+   }
+
+   size_t pread_all( char* d, size_t n, size_t offset ) {
+      size_t done = 0;
+      while( done < n ) {
+         ssize_t r = ::pread( _fd, d + done, n - done, offset + done );
+         if( r < 0 ) {
+            if( errno == EINTR )
+               continue;
+            throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                          " unable to read " + std::to_string( n ) + " bytes, error: " + std::to_string( errno ) );
+         }
+         if( r == 0 )
+            break;
+         done += r;
+      }
+      return done;
+   }
+
+   void pwrite_all( int fd, const char* d, size_t n, size_t offset ) {
+      size_t done = 0;
+      while( done < n ) {
+         ssize_t r = ::pwrite( fd, d + done, n - done, offset + done );
+         if( r < 0 ) {
+            if( errno == EINTR )
+               continue;
+            throw std::ios_base::failure( "fd_file: " + _file_path.generic_string() +
+                                          " unable to write " + std::to_string( n ) + " bytes; only wrote " + std::to_string( done ) +
+                                          ", error: " + std::to_string( errno ) );
+         }
+         done += r;
+      }
+   }
+
+   size_t read_some( char* d, size_t n ) {
+      flush_write_buffer();
+
+      // serve from the read buffer, refilling it for small reads
+      if( _pos >= _rbuf_off && _pos < _rbuf_off + _rbuf_len ) {
+         size_t avail = std::min( n, _rbuf_off + _rbuf_len - _pos );
+         memcpy( d, _rbuf.get() + ( _pos - _rbuf_off ), avail );
+         if( avail == n )
+            return n;
+         return avail + read_direct_or_buffered( d + avail, n - avail, _pos + avail );
+      }
+      return read_direct_or_buffered( d, n, _pos );
+   }
+
+   size_t read_direct_or_buffered( char* d, size_t n, size_t offset ) {
+      if( n >= _rbuf_capacity )
+         return pread_all( d, n, offset );
+
+      _rbuf_off = offset;
+      _rbuf_len = pread_all( _rbuf.get(), _rbuf_capacity, offset );
+      size_t avail = std::min( n, _rbuf_len );
+      memcpy( d, _rbuf.get(), avail );
+      return avail;
+   }
+
+   void invalidate_read_buffer( size_t offset, size_t n ) {
+      if( _rbuf_len && offset < _rbuf_off + _rbuf_len && _rbuf_off < offset + n )
+         _rbuf_len = 0;
+   }
+
+   void flush_write_buffer() {
+      if( !_wbuf_len )
+         return;
+
+      size_t done = 0;
+      if( _direct_fd != -1 && _wbuf_off % _file_blk_size == 0 ) {
+         // O_DIRECT needs block aligned offset, length and memory; the tail goes through the page cache
+         size_t aligned = _wbuf_len - _wbuf_len % _file_blk_size;
+         if( aligned ) {
+            ssize_t r = ::pwrite( _direct_fd, _wbuf.get(), aligned, _wbuf_off );
+            if( r == static_cast<ssize_t>( aligned ) ) {
+               done = aligned;
+            } else if( r < 0 && errno == EINVAL ) {
+               ::close( _direct_fd );
+               _direct_fd = -1;
+            } else if( r > 0 ) {
+               done = r;
+            }
+         }
+      }
+      pwrite_all( _fd, _wbuf.get() + done, _wbuf_len - done, _wbuf_off + done );
+      _wbuf_len = 0;
+   }
+
+   bool                     _open = false;
+   bool                     _append = false;
+   bool                     _direct = false;
+   bool                     _eof = false;
+   fc::path                 _file_path;
+   size_t                   _file_blk_size = 4096;
+   int                      _fd = -1;
+   int                      _direct_fd = -1;
+   size_t                   _pos = 0;
+   size_t                   _size = 0;
+
+   detail::aligned_buffer   _wbuf{nullptr, &free};
+   size_t                   _wbuf_capacity = 0;
+   size_t                   _wbuf_off = 0;
+   size_t                   _wbuf_len = 0;
+   size_t                   _wbuf_request = default_write_buffer_size;
+
+   detail::aligned_buffer   _rbuf{nullptr, &free};
+   size_t                   _rbuf_capacity = 0;
+   size_t                   _rbuf_off = 0;
+   size_t                   _rbuf_len = 0;
+   size_t                   _rbuf_request = default_read_buffer_size;
+};
+
+inline fd_file_datastream fd_file::create_datastream() {
+   return fd_file_datastream(*this);
+}
+
+template <>
+class datastream<fc::fd_file, void> : public fc::fd_file {
+ public:
+   using fc::fd_file::fd_file;
+
+   bool seekp(size_t pos) { return this->seek(pos), true; }
+
+   bool get(char& c) {
+      c = this->getc();
+      return true;
+   }
+
+   fc::fd_file&       storage() { return *this; }
+   const fc::fd_file& storage() const { return *this; }
+};
+
+} // namespace fc
@@ -34,10 +34,37 @@ namespace fc
          using yield_function_t = fc::optional_delegate<void(size_t)>;
          static constexpr uint64_t max_length_limit = std::numeric_limits<uint64_t>::max();
          static constexpr size_t escape_string_yield_check_count = 128;
+
+         /**
+          *  Yield policy of the deadline overloads of to_string and to_pretty_string. The output length is checked
+          *  against max_len on every call, the deadline only on the first and every deadline_check_interval-th
+          *  call after it, so the clock is not read for every element and every 128 escaped characters.
+          */
+         class deadline_yield {
+            public:
+               static constexpr uint32_t deadline_check_interval = 16;
+
+               deadline_yield( const fc::time_point& deadline, uint64_t max_len )
+               :_deadline(deadline),_max_len(max_len){}
+
+               void operator()( size_t s ) {
+                  if( _calls++ % deadline_check_interval == 0 )
+                     FC_CHECK_DEADLINE(_deadline);
+                  FC_ASSERT( s <= _max_len );
+               }
+
+            private:
+               fc::time_point _deadline;
+               uint64_t       _max_len;
+               uint32_t       _calls = 0;
+         };
+
          static variant  from_string( const string& utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
          static variants variants_from_string( const string& utf8_str, const parse_type ptype = parse_type::legacy_parser, uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
          static string   to_string( const variant& v, const yield_function_t& yield, const output_formatting format = output_formatting::stringify_large_ints_and_doubles);
          static string   to_pretty_string( const variant& v, const yield_function_t& yield, const output_formatting format = output_formatting::stringify_large_ints_and_doubles );
+         static string   to_string( const variant& v, const fc::time_point& deadline, const output_formatting format = output_formatting::stringify_large_ints_and_doubles, const uint64_t max_len = max_length_limit );
+         static string   to_pretty_string( const variant& v, const fc::time_point& deadline, const output_formatting format = output_formatting::stringify_large_ints_and_doubles, const uint64_t max_len = max_length_limit );
 
          static bool     is_valid( const std::string& json_str, const parse_type ptype = parse_type::legacy_parser, const uint32_t max_depth = DEFAULT_MAX_RECURSION_DEPTH );
 
@@ -59,21 +86,13 @@ namespace fc
          template<typename T>
          static string   to_string( const T& v, const fc::time_point& deadline, const output_formatting format = output_formatting::stringify_large_ints_and_doubles, const uint64_t max_len = max_length_limit )
          {
-            const auto yield = [&](size_t s) {
-               FC_CHECK_DEADLINE(deadline);
-               FC_ASSERT(s <= max_len);
-            };
-            return to_string( variant(v), yield, format );
+            return to_string( variant(v), deadline, format, max_len );
          }
 
          template<typename T>
          static string   to_pretty_string( const T& v, const fc::time_point& deadline = fc::time_point::maximum(), const output_formatting format = output_formatting::stringify_large_ints_and_doubles, const uint64_t max_len = max_length_limit )
          {
-            const auto yield = [&](size_t s) {
-               FC_CHECK_DEADLINE(deadline);
-               FC_ASSERT( s <= max_len );
-            };
-            return to_pretty_string( variant(v), yield, format );
+            return to_pretty_string( variant(v), deadline, format, max_len );
          }
 
          template<typename T>
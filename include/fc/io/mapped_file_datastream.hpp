@@ -0,0 +1,95 @@
+#pragma once
+#include <fc/io/datastream.hpp>
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/filesystem.hpp>
+
+#include <memory>
+#include <string_view>
+
+namespace fc {
+
+/**
+ *  @brief read-only datastream over a memory mapped file for use with fc unpack
+ *
+ *  Reads are served straight from the mapping: primitives are a bounds check and a memcpy, skip() only moves
+ *  the position and read_view() hands out pointers into the mapping without copying.
+ *
+ *  By default the whole file is mapped. When a window size is given only that much of the file is mapped at a
+ *  time and the window slides as the stream advances, which bounds the address space used for very large
+ *  files. Pointers returned by read_view() stay valid until the window moves, i.e. until the next call that
+ *  reads outside of the current window.
+ *
+ *  The access pattern is passed to the kernel via madvise; on Linux the mapping is also marked as eligible for
+ *  transparent huge pages and windows are aligned to 2 MiB.
+ */
+class mapped_file_datastream {
+public:
+   static constexpr size_t window_alignment = 2*1024*1024;
+
+   /// @param window_size 0 maps the whole file, otherwise the size of the sliding window (rounded up to window_alignment)
+   explicit mapped_file_datastream( const fc::path& file, advice_t access = advice_sequential, size_t window_size = 0 );
+   ~mapped_file_datastream();
+
+   mapped_file_datastream( const mapped_file_datastream& ) = delete;
+   mapped_file_datastream& operator=( const mapped_file_datastream& ) = delete;
+
+   inline bool read( char* d, size_t s ) {
+      // unsigned wrap makes off huge when _pos is before the window
+      const size_t off = _pos - _win_begin;
+      if( off < _win_len && s <= _win_len - off ) {
+         memcpy( d, _win_addr + off, s );
+         _pos += s;
+         return true;
+      }
+      return read_slow( d, s );
+   }
+
+   inline bool get( unsigned char& c ) { return get( *(char*)&c ); }
+   inline bool get( char& c ) {
+      const size_t off = _pos - _win_begin;
+      if( off < _win_len ) {
+         c = _win_addr[off];
+         ++_pos;
+         return true;
+      }
+      return read_slow( &c, 1 );
+   }
+
+   /// moves the position without touching the skipped bytes
+   inline void skip( size_t s ) {
+      if( s > remaining() )
+         detail::throw_datastream_range_error( "skip", _size, int64_t( s - remaining() ) );
+      _pos += s;
+   }
+
+   /**
+    *  Returns a pointer to the next s bytes in the mapping and advances past them.
+    *  In windowed mode the bytes must fit in one window.
+    */
+   const char* read_view( size_t s );
+
+   /// zero-copy unpack of a length prefixed byte array as packed for std::string or std::vector<char>
+   std::string_view read_bytes_view();
+
+   inline bool     seekp( size_t p )  { _pos = p; return _pos <= _size; }
+   inline size_t   tellp() const      { return _pos; }
+   inline size_t   remaining() const  { return _pos <= _size ? _size - _pos : 0; }
+   inline bool     valid() const      { return _pos <= _size; }
+   inline size_t   size() const       { return _size; }
+
+private:
+   bool read_slow( char* d, size_t s );
+   void map_window( size_t pos, size_t need );
+
+   std::unique_ptr<fc::file_mapping>  _mapping;
+   std::unique_ptr<fc::mapped_region> _region;
+   advice_t                           _access;
+   size_t                             _window_size;
+   size_t                             _size = 0;
+   size_t                             _pos = 0;
+   size_t                             _win_begin = 0;
+   size_t                             _win_len = 0;
+   const char*                        _win_addr = nullptr;
+};
+
+} // namespace fc
@@ -1,6 +1,10 @@
 #pragma once
 #include <fc/io/cfile.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/crypto/crc.hpp>
+
+#include <set>
+#include <unistd.h>
 
 namespace fc {
 
@@ -11,7 +15,7 @@ namespace fc {
 
 namespace persistence_util {
 
-   cfile open_cfile_for_read(const fc::path& dir, const std::string& filename) {
+   inline cfile open_cfile_for_read(const fc::path& dir, const std::string& filename) {
       if (!fc::is_directory(dir))
          fc::create_directories(dir);
       
@@ -25,7 +29,7 @@ namespace persistence_util {
       return dat_content;
    }
 
-   uint32_t read_persistence_header(cfile& dat_content, const uint32_t magic_number, const uint32_t min_supported_version,
+   inline uint32_t read_persistence_header(cfile& dat_content, const uint32_t magic_number, const uint32_t min_supported_version,
       const uint32_t max_supported_version) {
       dat_content.seek(0); // needed on mac
       auto ds = dat_content.create_datastream();
@@ -55,7 +59,7 @@ namespace persistence_util {
       return version;
    }
 
-   cfile open_cfile_for_write(const fc::path& dir, const std::string& filename) {
+   inline cfile open_cfile_for_write(const fc::path& dir, const std::string& filename) {
       if (!fc::is_directory(dir))
          fc::create_directories(dir);
 
@@ -66,10 +70,304 @@ namespace persistence_util {
       return dat_content;
    }
 
-   void write_persistence_header(cfile& dat_content, const uint32_t magic_number, const uint32_t current_version) {
+   inline void write_persistence_header(cfile& dat_content, const uint32_t magic_number, const uint32_t current_version) {
       dat_content.write( reinterpret_cast<const char*>(&magic_number), sizeof(magic_number) );
       dat_content.write( reinterpret_cast<const char*>(&current_version), sizeof(current_version) );
    }
+
+   /**
+    * A sealed persistence file is a persistence header followed by the size and crc32c of the content that
+    * follows it. A file whose size does not match the recorded content size was torn by a crash and is
+    * rejected by read_sealed_persistence_header without unpacking anything.
+    */
+   struct persistence_seal {
+      uint64_t content_size = 0;
+      uint32_t crc          = 0;
+   };
+
+   constexpr size_t sealed_header_size = 2*sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+   namespace detail {
+      inline uint32_t content_crc(cfile& dat_content, size_t begin, size_t size) {
+         std::vector<char> buf( std::min<size_t>( size, 1024*1024 ) );
+         uint32_t crc = 0;
+         dat_content.seek( begin );
+         while( size ) {
+            const size_t n = std::min( size, buf.size() );
+            dat_content.read( buf.data(), n );
+            crc = fc::crc32c( buf.data(), n, crc );
+            size -= n;
+         }
+         return crc;
+      }
+
+      [[noreturn]] inline void throw_io_error(const fc::path& p, const char* what) {
+         throw std::ios_base::failure( "persistence_util: " + p.generic_string() + " " + what + ", error: " + std::to_string( errno ) );
+      }
+   }
+
+   /**
+    * Reads a header written by atomic_writer and leaves dat_content positioned at the start of the content.
+    * A size mismatch (torn file) is always detected; the content crc is checked only if verify_checksum is set
+    * since that requires reading the whole file.
+    */
+   inline uint32_t read_sealed_persistence_header(cfile& dat_content, const uint32_t magic_number,
+                                                  const uint32_t min_supported_version, const uint32_t max_supported_version,
+                                                  bool verify_checksum = false) {
+      const uint32_t version = read_persistence_header( dat_content, magic_number, min_supported_version, max_supported_version );
+
+      persistence_seal seal;
+      dat_content.read( reinterpret_cast<char*>(&seal.content_size), sizeof(seal.content_size) );
+      dat_content.read( reinterpret_cast<char*>(&seal.crc), sizeof(seal.crc) );
+
+      dat_content.seek_end( 0 );
+      const size_t file_size = dat_content.tellp();
+      if( file_size != sealed_header_size + seal.content_size ) {
+         FC_THROW_EXCEPTION(fc::parse_error_exception,
+                            "Torn persistence file ${f}: size ${s}, expected ${e}",
+                            ("f", dat_content.get_file_path())("s", file_size)("e", sealed_header_size + seal.content_size));
+      }
+
+      if( verify_checksum ) {
+         const uint32_t crc = detail::content_crc( dat_content, sealed_header_size, seal.content_size );
+         if( crc != seal.crc ) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception,
+                               "Persistence file ${f} failed crc check: ${crc} != ${expected}",
+                               ("f", dat_content.get_file_path())("crc", crc)("expected", seal.crc));
+         }
+      }
+
+      dat_content.seek( sealed_header_size );
+      return version;
+   }
+
+   /**
+    * Writes a persistence file so that a crash never leaves a partially written file in its place.
+    *
+    * Content is written through file() to an anonymous O_TMPFILE (or a hidden temporary file where that is not
+    * supported) in the target directory. Content must be written sequentially; its crc is computed as it is
+    * written. commit() seals the header with the content size and crc, syncs the data once and renames the file
+    * over the target. A writer destroyed without commit() discards its data.
+    *
+    * commit_all() commits several writers together: each file's data is synced, then all are renamed and each
+    * directory is synced once.
+    */
+   class atomic_writer {
+   public:
+      atomic_writer(const fc::path& dir, const std::string& filename, const uint32_t magic_number, const uint32_t current_version)
+      : _dir( dir ), _target( dir / filename ) {
+         if (!fc::is_directory(dir))
+            fc::create_directories(dir);
+
+         int fd = -1;
+#ifdef O_TMPFILE
+         fd = ::open( dir.generic_string().c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0644 );
+#endif
+         if( fd == -1 ) {
+            // hidden temporary next to the target so the rename stays on one filesystem
+            std::string tmpl = ( dir / ( "." + filename + ".XXXXXX" ) ).generic_string();
+            fd = mkstemp( tmpl.data() );
+            if( fd == -1 )
+               detail::throw_io_error( _target, "unable to create temporary file" );
+            _tmp_path = tmpl;
+         }
+
+         _file.set_file_path( _target );
+         _file.open_fd( fd, "wb+" );
+         write_persistence_header( _file, magic_number, current_version );
+         const persistence_seal seal;
+         _file.write( reinterpret_cast<const char*>(&seal.content_size), sizeof(seal.content_size) );
+         _file.write( reinterpret_cast<const char*>(&seal.crc), sizeof(seal.crc) );
+         _file.track_writes();
+      }
+
+      atomic_writer(const atomic_writer&) = delete;
+      atomic_writer& operator=(const atomic_writer&) = delete;
+
+      ~atomic_writer() {
+         if( !_committed && !_tmp_path.empty() )
+            ::unlink( _tmp_path.generic_string().c_str() );
+      }
+
+      /// positioned after the sealed header; write content here
+      cfile& file() { return _file; }
+
+      const fc::path& get_file_path() const { return _target; }
+
+      void commit() { commit_all( {this} ); }
+
+      static void commit_all(const std::vector<atomic_writer*>& writers) {
+         for( auto* w : writers )
+            w->seal();
+
+#if defined(__linux__)
+         for( auto* w : writers )
+            if( fdatasync( w->_file.fileno() ) != 0 )
+               detail::throw_io_error( w->_target, "unable to fdatasync" );
+#else
+         for( auto* w : writers )
+            w->_file.sync();
+#endif
+
+         std::set<fc::path> dirs;
+         for( auto* w : writers ) {
+            w->publish();
+            dirs.insert( w->_dir );
+         }
+         for( const auto& d : dirs ) {
+            int dfd = ::open( d.generic_string().c_str(), O_RDONLY | O_CLOEXEC );
+            if( dfd == -1 )
+               detail::throw_io_error( d, "unable to open directory" );
+            const int r = fsync( dfd );
+            ::close( dfd );
+            if( r != 0 )
+               detail::throw_io_error( d, "unable to sync directory" );
+         }
+      }
+
+   private:
+      void seal() {
+         _file.flush();
+         _file.seek_end( 0 );
+         persistence_seal seal;
+         seal.content_size = _file.tellp() - sealed_header_size;
+         FC_ASSERT( seal.content_size == _file.written_size(),
+                    "Content of ${f} was not written sequentially: ${s} bytes in file, ${w} bytes written",
+                    ("f", _target)("s", seal.content_size)("w", _file.written_size()) );
+         seal.crc = _file.written_crc();
+         _file.seek( 2*sizeof(uint32_t) );
+         _file.write( reinterpret_cast<const char*>(&seal.content_size), sizeof(seal.content_size) );
+         _file.write( reinterpret_cast<const char*>(&seal.crc), sizeof(seal.crc) );
+         _file.flush();
+      }
+
+      void publish() {
+         if( _tmp_path.empty() ) {
+            // give the anonymous file a name, then move it over the target
+            const std::string proc_path = "/proc/self/fd/" + std::to_string( _file.fileno() );
+            std::string tmp = ( _dir / ( "." + _target.filename().generic_string() + ".XXXXXX" ) ).generic_string();
+            int fd = mkstemp( tmp.data() ); // reserve a unique name
+            if( fd == -1 )
+               detail::throw_io_error( _target, "unable to create temporary name" );
+            ::close( fd );
+            ::unlink( tmp.c_str() );
+            if( linkat( AT_FDCWD, proc_path.c_str(), AT_FDCWD, tmp.c_str(), AT_SYMLINK_FOLLOW ) != 0 )
+               detail::throw_io_error( _target, "unable to link temporary file" );
+            _tmp_path = tmp;
+         }
+         if( ::rename( _tmp_path.generic_string().c_str(), _target.generic_string().c_str() ) != 0 )
+            detail::throw_io_error( _target, "unable to rename temporary file" );
+         _committed = true;
+         _file.close();
+      }
+
+      fc::path _dir;
+      fc::path _target;
+      fc::path _tmp_path; // empty while the file is anonymous
+      cfile    _file;
+      bool     _committed = false;
+   };
+
+   /**
+    * Table written ahead of a chunked section (see tracked_storage::write_chunked). Offsets are relative to
+    * the first byte after the table so the table can be written before the chunk data. The table is followed
+    * by the crc32c of its packed form.
+    */
+   struct chunk_info {
+      uint64_t offset = 0;
+      uint64_t size   = 0;
+      uint64_t items  = 0;
+      uint32_t crc    = 0; // crc32c of the chunk data
+   };
+
+   struct chunk_table {
+      uint64_t                total_items = 0;
+      std::vector<chunk_info> chunks;
+
+      uint64_t data_size() const { return chunks.empty() ? 0 : chunks.back().offset + chunks.back().size; }
+   };
+
+   constexpr uint32_t chunk_table_version = 1;
+} // namespace persistence_util
+} // namespace fc
+
+FC_REFLECT( fc::persistence_util::chunk_info, (offset)(size)(items)(crc) )
+
+namespace fc {
+namespace persistence_util {
+
+   namespace detail {
+      inline uint32_t chunk_table_crc(const chunk_table& table) {
+         auto data = fc::raw::pack( std::make_pair( chunk_table_version, table.total_items ) );
+         const uint32_t crc = fc::crc32c( data.data(), data.size() );
+         data = fc::raw::pack( table.chunks );
+         return fc::crc32c( data.data(), data.size(), crc );
+      }
+   }
+
+   inline void write_chunk_table(cfile& dat_content, const chunk_table& table) {
+      auto data = fc::raw::pack( std::make_pair( chunk_table_version, table.total_items ) );
+      dat_content.write( data.data(), data.size() );
+      data = fc::raw::pack( table.chunks );
+      dat_content.write( data.data(), data.size() );
+      const uint32_t crc = detail::chunk_table_crc( table );
+      dat_content.write( reinterpret_cast<const char*>(&crc), sizeof(crc) );
+   }
+
+   /**
+    * Reads and checks a table written by write_chunk_table(): its crc, that the chunks are contiguous and fit
+    * in the rest of the file, and that no chunk claims more items than it has bytes. Nothing is allocated
+    * from the chunk sizes before these checks.
+    */
+   inline chunk_table read_chunk_table(cfile& dat_content) {
+      auto ds = dat_content.create_datastream();
+
+      uint32_t version = 0;
+      fc::raw::unpack( ds, version );
+      if( version != chunk_table_version ) {
+         FC_THROW_EXCEPTION(fc::parse_error_exception,
+                            "Unsupported chunk table version ${version}, expected ${expected}",
+                            ("version", version)("expected", chunk_table_version));
+      }
+
+      chunk_table table;
+      fc::raw::unpack( ds, table.total_items );
+      fc::raw::unpack( ds, table.chunks );
+      uint32_t crc = 0;
+      fc::raw::unpack( ds, crc );
+      const uint32_t expected = detail::chunk_table_crc( table );
+      if( crc != expected ) {
+         FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk table failed crc check: ${crc} != ${expected}",
+                            ("crc", crc)("expected", expected));
+      }
+
+      const size_t data_start = dat_content.tellp();
+      dat_content.seek_end( 0 );
+      const size_t available = dat_content.tellp() - data_start;
+      dat_content.seek( data_start );
+
+      uint64_t offset = 0, items = 0;
+      for( const auto& c : table.chunks ) {
+         if( c.offset != offset ) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk table is not contiguous at offset ${o}", ("o", c.offset));
+         }
+         if( c.size > available - offset ) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk at offset ${o} of ${s} bytes extends past the end of the file",
+                               ("o", c.offset)("s", c.size));
+         }
+         if( c.items > c.size ) {
+            FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk at offset ${o} lists ${i} items in ${s} bytes",
+                               ("o", c.offset)("i", c.items)("s", c.size));
+         }
+         offset += c.size;
+         items += c.items;
+      }
+      if( items != table.total_items ) {
+         FC_THROW_EXCEPTION(fc::parse_error_exception, "Chunk table lists ${i} items, header expects ${t}",
+                            ("i", items)("t", table.total_items));
+      }
+      return table;
+   }
 } // namespace persistence_util
 
 } // namespace fc
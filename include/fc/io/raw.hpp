@@ -16,6 +16,7 @@
 #include <deque>
 #include <list>
 
+#include <boost/endian/conversion.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
@@ -202,27 +203,83 @@ namespace fc {
       if( b ) { v = std::make_shared<T>(); fc::raw::unpack( s, *v ); }
     } FC_RETHROW_EXCEPTIONS( warn, "std::shared_ptr<T>", ("type",fc::get_typename<T>::name()) ) }
 
+    namespace detail {
+
+      /**
+       *  Encodes v as a varint into the low bytes of w, byte i of the encoding being bits 8i to 8i+7, and returns
+       *  the length (1 to 5 bytes).
+       */
+      inline size_t encode_varint32( uint32_t v, uint64_t& w ) {
+        const size_t   n = 1 + (v >= 1u<<7) + (v >= 1u<<14) + (v >= 1u<<21) + (v >= 1u<<28);
+        const uint64_t x = v;
+        w = (x & 0x7f) | ((x & 0x3f80) << 1) | ((x & 0x1fc000) << 2) | ((x & 0xfe00000) << 3) | ((x & 0xf0000000) << 4);
+        w |= 0x80808080ull & ((1ull << (8 * (n - 1))) - 1);    // continuation bit on all but the last byte
+        return n;
+      }
+
+      template<typename Stream>
+      inline void pack_varint32( Stream& s, uint32_t v ) {
+        uint64_t w;
+        const size_t n = encode_varint32( v, w );
+        if constexpr( std::is_same_v<Stream, fc::datastream<char*>> ) {
+          if( s.remaining() >= 8 ) {
+            // a single 8 byte store that leaves the bytes following the varint as they were
+            char* p = s.pos();
+            uint64_t old;
+            memcpy( &old, p, sizeof(old) );
+            const uint64_t mask = (1ull << (8 * n)) - 1;
+            w = boost::endian::native_to_little( (boost::endian::little_to_native( old ) & ~mask) | w );
+            memcpy( p, &w, sizeof(w) );
+            s.skip( n );
+            return;
+          }
+        }
+        w = boost::endian::native_to_little( w );
+        s.write( (const char*)&w, n );
+      }
+
+      /**
+       *  Decodes a varint from p, which must have at least 8 readable bytes, and returns the number of bytes it
+       *  occupies. Decodes exactly like the byte loop of unpack(unsigned_int): at most 5 bytes are consumed and
+       *  bits beyond 32 are dropped, so overlong encodings give the same value and length as before. The result
+       *  is 5 with the continuation bit of p[4] still set when no terminator was found in the first 5 bytes.
+       */
+      inline size_t decode_varint32( const char* p, uint32_t& v ) {
+        uint64_t w;
+        memcpy( &w, p, sizeof(w) );
+        w = boost::endian::little_to_native( w );
+        const uint64_t stop = ~w & 0x8080808080ull;           // a clear high bit marks the last byte
+        const size_t   n    = stop ? __builtin_ctzll( stop ) / 8 + 1 : 5;
+        const uint64_t x    = w & ((1ull << (8 * n)) - 1);
+        v = uint32_t( (x & 0x7f) | ((x >> 1) & 0x3f80) | ((x >> 2) & 0x1fc000) | ((x >> 3) & 0xfe00000) | ((x >> 4) & 0x7f0000000ull) );
+        return n;
+      }
+
+    } // namespace detail
+
     template<typename Stream> inline void pack( Stream& s, const signed_int& v ) {
       uint32_t val = (v.value<<1) ^ (v.value>>31);              //apply zigzag encoding
-      do {
-        uint8_t b = uint8_t(val) & 0x7f;
-        val >>= 7;
-        b |= ((val > 0) << 7);
-        s.write((char*)&b,1);//.put(b);
-      } while( val );
+      detail::pack_varint32( s, val );
     }
 
     template<typename Stream> inline void pack( Stream& s, const unsigned_int& v ) {
-      uint64_t val = v.value;
-      do {
-        uint8_t b = uint8_t(val) & 0x7f;
-        val >>= 7;
-        b |= ((val > 0) << 7);
-        s.write((char*)&b,1);//.put(b);
-      }while( val );
+      detail::pack_varint32( s, v.value );
     }
 
     template<typename Stream> inline void unpack( Stream& s, signed_int& vi ) {
+      if constexpr( fc::is_contiguous_datastream<Stream> ) {
+        if( s.remaining() >= 8 ) {
+          const char* p = reinterpret_cast<const char*>( s.pos() );
+          uint32_t v;
+          const size_t n = detail::decode_varint32( p, v );
+          // unlike unsigned_int the byte loop keeps reading past 5 bytes, leave such encodings to it
+          if( n < 5 || !(uint8_t(p[4]) & 0x80) ) {
+            s.skip( n );
+            vi.value= (v>>1) ^ (~(v&1)+1ull);                   //reverse zigzag encoding
+            return;
+          }
+        }
+      }
       uint32_t v = 0; char b = 0; int by = 0;
       do {
         s.get(b);
@@ -233,6 +290,14 @@ namespace fc {
     }
 
     template<typename Stream> inline void unpack( Stream& s, unsigned_int& vi ) {
+      if constexpr( fc::is_contiguous_datastream<Stream> ) {
+        if( s.remaining() >= 8 ) {
+          uint32_t v;
+          s.skip( detail::decode_varint32( reinterpret_cast<const char*>( s.pos() ), v ) );
+          vi.value = v;
+          return;
+        }
+      }
       uint64_t v = 0; char b = 0; uint8_t by = 0;
       do {
           s.get(b);
@@ -335,8 +400,227 @@ namespace fc {
        v=(b!=0);
     }
 
+    /**
+     *  Stream type used only in unevaluated calls, to tell whether fc::raw::pack/unpack of a reflected class resolve
+     *  to the generic reflected overloads. A class with its own pack or unpack overload makes the call ambiguous.
+     */
+    struct reflected_probe_stream {};
+    template<typename T> reflected_probe_stream pack( reflected_probe_stream& s, const T& v );
+    template<typename T> reflected_probe_stream unpack( reflected_probe_stream& s, T& v );
+
+    template<typename T, typename Enable = void>
+    constexpr bool uses_reflected_pack = false;
+
+    template<typename T>
+    constexpr bool uses_reflected_pack<T, std::enable_if_t<
+          std::is_same_v<decltype( pack( std::declval<reflected_probe_stream&>(), std::declval<const T&>() ) ), reflected_probe_stream> &&
+          std::is_same_v<decltype( unpack( std::declval<reflected_probe_stream&>(), std::declval<T&>() ) ), reflected_probe_stream>>> = true;
+
     namespace detail {
 
+      struct static_pack_size_visitor {
+        size_t size  = 0;
+        bool   fixed = true;
+
+        template<typename Member, class Class, Member (Class::*member)>
+        constexpr void operator()( const char* name ) {
+          constexpr size_t s = static_pack_size<std::remove_cv_t<Member>>::value;
+          fixed = fixed && s != 0;
+          size += s;
+        }
+      };
+
+      template<typename T>
+      constexpr size_t static_pack_size_of() {
+        if constexpr( std::is_arithmetic_v<T> || std::is_same_v<T, __int128> || std::is_same_v<T, unsigned __int128> ) {
+          return sizeof(T);
+        } else if constexpr( std::is_enum_v<T> ) {
+          // reflected enums are packed as int64_t, others by their underlying representation
+          return fc::reflector<T>::is_enum::value ? sizeof(int64_t) : sizeof(T);
+        } else if constexpr( fc::reflector<T>::is_defined::value && uses_reflected_pack<T> ) {
+          static_pack_size_visitor v;
+          fc::reflector<T>::visit( v );
+          return v.fixed ? v.size : 0;
+        } else {
+          return 0;
+        }
+      }
+
+    } // namespace detail
+
+    /**
+     *  Computed at compile time for arithmetic types, enums and reflected classes whose members all have a static
+     *  pack size. Reflected classes that provide their own pack or unpack overloads count as variable sized; they
+     *  can specialize static_pack_size if their packed form does have a fixed size.
+     */
+    template<typename T, typename Enable>
+    struct static_pack_size : std::integral_constant<size_t, detail::static_pack_size_of<T>()> {};
+
+    template<> struct static_pack_size<fc::time_point>     : std::integral_constant<size_t, sizeof(uint64_t)> {};
+    template<> struct static_pack_size<fc::time_point_sec> : std::integral_constant<size_t, sizeof(uint32_t)> {};
+    template<> struct static_pack_size<fc::microseconds>   : std::integral_constant<size_t, sizeof(uint64_t)> {};
+
+    // arrays of scalars, including reflected enums, are written as their in-memory representation
+    template<typename T, size_t N>
+    struct static_pack_size<fc::array<T,N>>
+    : std::integral_constant<size_t, N * ( is_trivial_array<T> ? sizeof(T) : static_pack_size<T>::value )> {};
+
+    template<typename T, std::size_t S>
+    struct static_pack_size<std::array<T,S>>
+    : std::integral_constant<size_t, S * ( is_trivial_array<T> ? sizeof(T) : static_pack_size<T>::value )> {};
+
+    template<typename K, typename V>
+    struct static_pack_size<std::pair<K,V>>
+    : std::integral_constant<size_t, static_pack_size<K>::value && static_pack_size<V>::value ?
+                                     static_pack_size<K>::value + static_pack_size<V>::value : 0> {};
+
+    template<typename IntType, typename EnumType>
+    struct static_pack_size<fc::enum_type<IntType,EnumType>> : static_pack_size<IntType> {};
+
+    namespace detail {
+
+      template<size_t N>
+      struct field_size_visitor {
+        std::array<size_t, N> sizes{};
+        size_t                i = 0;
+
+        template<typename Member, class Class, Member (Class::*member)>
+        constexpr void operator()( const char* name ) {
+          sizes[i++] = static_pack_size<std::remove_cv_t<Member>>::value;
+        }
+      };
+
+      template<typename M, class C, M (C::*p)>
+      struct field_index_visitor {
+        size_t i = 0;
+        size_t index = 0;
+
+        template<typename Member, class Class, Member (Class::*member)>
+        constexpr void operator()( const char* name ) {
+          if constexpr( std::is_same_v<Member, M> && std::is_same_v<Class, C> ) {
+            if( member == p )
+              index = i;
+          }
+          ++i;
+        }
+      };
+
+      /**
+       *  Compile-time layout of a reflected class: the flattened list of fields, bases first, and the runs of
+       *  adjacent fields that have a static pack size. A run is range checked once and its fields are then
+       *  read or written without further checks.
+       */
+      template<typename T>
+      struct field_plan {
+        static constexpr size_t num_fields = fc::reflector<T>::total_member_count;
+
+        static constexpr std::array<size_t, num_fields> field_sizes() {
+          field_size_visitor<num_fields> v;
+          fc::reflector<T>::visit( v );
+          return v.sizes;
+        }
+
+        /// static pack size of each field, 0 if variable
+        static constexpr std::array<size_t, num_fields> sizes = field_sizes();
+
+        static constexpr std::array<size_t, num_fields> field_run_sizes() {
+          std::array<size_t, num_fields> runs{};
+          for( size_t i = 0; i < num_fields; ++i ) {
+            if( sizes[i] && ( i == 0 || !sizes[i-1] ) ) {
+              for( size_t j = i; j < num_fields && sizes[j]; ++j )
+                runs[i] += sizes[j];
+            }
+          }
+          return runs;
+        }
+
+        /// total size of the run starting at each field, 0 for fields that do not start a run
+        static constexpr std::array<size_t, num_fields> run_sizes = field_run_sizes();
+
+        /// true if field i is the last field of a run
+        static constexpr bool ends_run( size_t i ) {
+          return sizes[i] && ( i + 1 == num_fields || !sizes[i+1] );
+        }
+
+        template<typename M, class C, M (C::*p)>
+        static constexpr size_t index_of() {
+          field_index_visitor<M, C, p> v;
+          fc::reflector<T>::visit( v );
+          return v.index;
+        }
+      };
+
+      template<typename Stream, typename Class>
+      struct compiled_pack_visitor {
+        compiled_pack_visitor(const Class& _c, Stream& _s)
+        :c(_c),s(_s){}
+
+        template<typename T, typename C, T(C::*p)>
+        inline void operator()( const char* name )const {
+          using plan = field_plan<Class>;
+          constexpr size_t i = plan::template index_of<T, C, p>();
+          if constexpr( plan::sizes[i] == 0 ) {
+            fc::raw::pack( s, c.*p );
+          } else {
+            if constexpr( plan::run_sizes[i] > 0 ) {
+              constexpr size_t run = plan::run_sizes[i];
+              if constexpr( !std::is_same_v<Stream, datastream<size_t>> ) {
+                if( s.remaining() < run )
+                  fc::detail::throw_datastream_range_error( "write", s.tellp() + s.remaining(), int64_t(run - s.remaining()) );
+                us = unchecked_write_datastream( s.pos() );
+              }
+              s.skip( run );
+            }
+            if constexpr( !std::is_same_v<Stream, datastream<size_t>> ) {
+              fc::raw::pack( us, c.*p );
+              if constexpr( plan::ends_run( i ) )
+                FC_ASSERT( us.pos() == s.pos(), "packed fields do not match the static_pack_size of ${type}",
+                           ("type", fc::get_typename<Class>::name()) );
+            }
+          }
+        }
+
+        private:
+          const Class&                       c;
+          Stream&                            s;
+          mutable unchecked_write_datastream us{nullptr};
+      };
+
+      template<typename Stream, typename Class>
+      struct compiled_unpack_visitor : public fc::reflector_init_visitor<Class> {
+        compiled_unpack_visitor(Class& _c, Stream& _s)
+        : fc::reflector_init_visitor<Class>(_c), s(_s){}
+
+        template<typename T, typename C, T(C::*p)>
+        inline void operator()( const char* name )const {
+          using plan = field_plan<Class>;
+          constexpr size_t i = plan::template index_of<T, C, p>();
+          field = name;
+          if constexpr( plan::sizes[i] == 0 ) {
+            fc::raw::unpack( s, this->obj.*p );
+          } else {
+            if constexpr( plan::run_sizes[i] > 0 ) {
+              constexpr size_t run = plan::run_sizes[i];
+              if( s.remaining() < run )
+                fc::detail::throw_datastream_range_error( "unpack", s.tellp() + s.remaining(), int64_t(run - s.remaining()) );
+              us = unchecked_datastream( reinterpret_cast<const char*>( s.pos() ) );
+              s.skip( run );
+            }
+            fc::raw::unpack( us, this->obj.*p );
+            if constexpr( plan::ends_run( i ) )
+              FC_ASSERT( us.pos() == reinterpret_cast<const char*>( s.pos() ), "unpacked fields do not match the static_pack_size of ${type}",
+                         ("type", fc::get_typename<Class>::name()) );
+          }
+        }
+
+        /// the field being unpacked, for error context
+        mutable const char* field = nullptr;
+
+        private:
+          Stream&                      s;
+          mutable unchecked_datastream us{nullptr};
+      };
+
       template<typename Stream, typename Class>
       struct pack_object_visitor {
         pack_object_visitor(const Class& _c, Stream& _s)
@@ -390,11 +674,23 @@ namespace fc {
       struct if_enum {
         template<typename Stream, typename T>
         static inline void pack( Stream& s, const T& v ) {
-          fc::reflector<T>::visit( pack_object_visitor<Stream,T>( v, s ) );
+          if constexpr( std::is_same_v<Stream, datastream<char*>> || std::is_same_v<Stream, datastream<size_t>> ) {
+            fc::reflector<T>::visit( compiled_pack_visitor<Stream,T>( v, s ) );
+          } else {
+            fc::reflector<T>::visit( pack_object_visitor<Stream,T>( v, s ) );
+          }
         }
         template<typename Stream, typename T>
         static inline void unpack( Stream& s, T& v ) {
-          fc::reflector<T>::visit( unpack_object_visitor<Stream,T>( v, s ) );
+          if constexpr( fc::is_contiguous_datastream<Stream> ) {
+            // one try block per object rather than per field; the visitor remembers which field failed
+            compiled_unpack_visitor<Stream,T> visitor( v, s );
+            try {
+              fc::reflector<T>::visit( visitor );
+            } FC_RETHROW_EXCEPTIONS( warn, "Error unpacking field ${field}", ("field",visitor.field) )
+          } else {
+            fc::reflector<T>::visit( unpack_object_visitor<Stream,T>( v, s ) );
+          }
         }
       };
       template<>
@@ -778,8 +1074,7 @@ namespace fc {
     {
        unsigned_int w;
        fc::raw::unpack( s, w );
-       fc::from_index(sv, w.value);
-       std::visit( unpack_static_variant<Stream>(s), sv );
+       fc::emplace_index( sv, w.value, unpack_static_variant<Stream>(s) );
     }
 
 
@@ -806,4 +1101,116 @@ namespace fc {
        n |= tmp[0];
     }
 
+    namespace detail {
+
+      template<typename Stream>
+      inline void skip_bytes( Stream& s, size_t n ) {
+        if constexpr( fc::is_contiguous_datastream<Stream> ) {
+          if( s.remaining() < n )
+            fc::detail::throw_datastream_range_error( "skip", s.tellp() + s.remaining(), int64_t(n - s.remaining()) );
+        }
+        s.skip( n );
+      }
+
+      /**
+       *  Advances a stream past a packed T. Types with a static pack size are skipped in one step, byte arrays and
+       *  vectors after reading their length, reflected classes without their own pack overload member by member;
+       *  anything else is unpacked into a temporary.
+       */
+      template<typename T, typename Enable = void>
+      struct skip_packed {
+        template<typename Stream>
+        static void skip( Stream& s );
+      };
+
+      template<typename Stream>
+      struct skip_object_visitor {
+        Stream& s;
+
+        template<typename Member, class Class, Member (Class::*member)>
+        void operator()( const char* name )const
+        { try {
+          skip_packed<std::remove_cv_t<Member>>::skip( s );
+        } FC_RETHROW_EXCEPTIONS( warn, "Error skipping field ${field}", ("field",name) ) }
+      };
+
+      template<typename T, typename Enable>
+      template<typename Stream>
+      void skip_packed<T,Enable>::skip( Stream& s ) {
+        if constexpr( static_pack_size<T>::value > 0 ) {
+          skip_bytes( s, static_pack_size<T>::value );
+        } else if constexpr( fc::reflector<T>::is_defined::value && !fc::reflector<T>::is_enum::value && uses_reflected_pack<T> ) {
+          fc::reflector<T>::visit( skip_object_visitor<Stream>{ s } );
+        } else {
+          T tmp;
+          fc::raw::unpack( s, tmp );
+        }
+      }
+
+      template<typename T>
+      struct skip_packed<T, std::enable_if_t<std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<char>>>> {
+        template<typename Stream>
+        static void skip( Stream& s ) {
+          unsigned_int size; fc::raw::unpack( s, size );
+          FC_ASSERT( size.value <= MAX_SIZE_OF_BYTE_ARRAYS );
+          skip_bytes( s, size.value );
+        }
+      };
+
+      template<typename T>
+      struct skip_packed<std::vector<T>, std::enable_if_t<!std::is_same_v<T, char>>> {
+        template<typename Stream>
+        static void skip( Stream& s ) {
+          unsigned_int size; fc::raw::unpack( s, size );
+          FC_ASSERT( size.value <= MAX_NUM_ARRAY_ELEMENTS );
+          if constexpr( static_pack_size<T>::value > 0 ) {
+            skip_bytes( s, size_t(size.value) * static_pack_size<T>::value );
+          } else {
+            for( uint32_t i = 0; i < size.value; ++i )
+              skip_packed<T>::skip( s );
+          }
+        }
+      };
+
+      template<typename T>
+      struct skip_packed<std::optional<T>> {
+        template<typename Stream>
+        static void skip( Stream& s ) {
+          bool b; fc::raw::unpack( s, b );
+          if( b ) skip_packed<T>::skip( s );
+        }
+      };
+
+      template<typename K, typename V>
+      struct skip_packed<std::pair<K,V>> {
+        template<typename Stream>
+        static void skip( Stream& s ) {
+          skip_packed<K>::skip( s );
+          skip_packed<V>::skip( s );
+        }
+      };
+
+      template<typename... T>
+      struct skip_packed<std::variant<T...>> {
+        template<typename Stream>
+        static void skip( Stream& s ) {
+          unsigned_int w; fc::raw::unpack( s, w );
+          FC_ASSERT( w.value < sizeof...(T), "invalid variant index ${i}", ("i", w.value) );
+          fc::visit_index<sizeof...(T)>( w.value, [&s]( auto i ) {
+            skip_packed<std::variant_alternative_t<decltype(i)::value, std::variant<T...>>>::skip( s );
+          } );
+        }
+      };
+
+    } // namespace detail
+
+    /**
+     *  Advances s past a packed T without constructing it, checking lengths the way unpack does. Used to find
+     *  element boundaries before unpacking them, e.g. by unpack_parallel().
+     */
+    template<typename T, typename Stream>
+    inline void skip( Stream& s ) {
+      detail::skip_packed<T>::skip( s );
+    }
+
 } } // namespace fc::raw
@@ -29,6 +29,13 @@ namespace fc {
     template<typename T>
     constexpr bool is_trivial_array = std::is_scalar<T>::value == true && std::is_pointer<T>::value == false;
 
+    /**
+     *  Number of bytes fc::raw::pack produces for every value of T, or 0 when the packed size depends on the value.
+     *  Defined in raw.hpp; specialize to std::integral_constant<size_t,0> to opt a type out.
+     */
+    template<typename T, typename Enable = void>
+    struct static_pack_size;
+
     template<typename T>
     inline size_t pack_size(  const T& v );
 
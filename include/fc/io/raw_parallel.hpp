@@ -0,0 +1,52 @@
+#pragma once
+#include <fc/io/raw.hpp>
+#include <fc/parallel_for.hpp>
+
+namespace fc { namespace raw {
+
+   /**
+    *  Unpacks a std::vector<T> of independently packed elements, e.g. the transactions of a block, on up to
+    *  num_threads threads. The result is the same as fc::raw::unpack( ds, v ).
+    *
+    *  A sequential pre-pass finds where each element starts, by size arithmetic for types with a static pack size
+    *  and with fc::raw::skip<T> otherwise. The elements are then unpacked in parallel into the pre-sized vector,
+    *  each from a datastream limited to its own bytes. If an element fails to unpack, or does not consume exactly
+    *  the bytes the pre-pass found for it, the exception is rethrown with the index of the element.
+    */
+   template<typename T>
+   void unpack_parallel( datastream<const char*>& ds, std::vector<T>& v, size_t num_threads ) {
+      unsigned_int size; fc::raw::unpack( ds, size );
+      FC_ASSERT( size.value <= MAX_NUM_ARRAY_ELEMENTS );
+      const size_t n     = size.value;
+      const char*  begin = ds.pos();
+
+      std::vector<size_t> offsets( n + 1 );
+      if constexpr( static_pack_size<T>::value > 0 ) {
+         for( size_t i = 0; i <= n; ++i )
+            offsets[i] = i * static_pack_size<T>::value;
+         detail::skip_bytes( ds, offsets[n] );
+      } else {
+         const size_t start = ds.tellp();
+         for( size_t i = 0; i < n; ++i ) {
+            offsets[i] = ds.tellp() - start;
+            try {
+               fc::raw::skip<T>( ds );
+            } FC_RETHROW_EXCEPTIONS( warn, "error skipping element ${i} of std::vector<${type}>",
+                                     ("i", i)("type", fc::get_typename<T>::name()) )
+         }
+         offsets[n] = ds.tellp() - start;
+      }
+
+      v.clear();
+      v.resize( n );
+      fc::detail::parallel_for( n, num_threads, [&]( size_t i ) {
+         try {
+            datastream<const char*> es( begin + offsets[i], offsets[i+1] - offsets[i] );
+            fc::raw::unpack( es, v[i] );
+            FC_ASSERT( es.remaining() == 0, "unpacked ${u} of ${s} bytes", ("u", es.tellp())("s", offsets[i+1] - offsets[i]) );
+         } FC_RETHROW_EXCEPTIONS( warn, "error unpacking element ${i} of std::vector<${type}>",
+                                  ("i", i)("type", fc::get_typename<T>::name()) )
+      } );
+   }
+
+} } // namespace fc::raw
@@ -55,11 +55,24 @@ namespace fc
    class log_context 
    {
       public:
+        /// selects the log_context constructor that references rather than copies its file and method
+        struct static_call_site_t { explicit static_call_site_t() = default; };
+        static constexpr static_call_site_t static_call_site{};
+
         log_context();
         log_context( log_level ll,
                     const char* file, 
                     uint64_t line, 
                     const char* method );
+        /**
+         *  Used by FC_LOG_CONTEXT.
+         *  @param file, method - must have static storage duration, as __FILE__ and __func__ do
+         */
+        log_context( static_call_site_t,
+                    log_level ll,
+                    const char* file,
+                    uint64_t line,
+                    const char* method );
         ~log_context();
         explicit log_context( const variant& v );
         variant to_variant()const;
@@ -151,7 +164,7 @@ FC_REFLECT_TYPENAME( fc::log_message );
  * @param LOG_LEVEL - a valid log_level::Enum name.
  */
 #define FC_LOG_CONTEXT(LOG_LEVEL) \
-   fc::log_context( fc::log_level::LOG_LEVEL, __FILE__, __LINE__, __func__ )
+   fc::log_context( fc::log_context::static_call_site, fc::log_level::LOG_LEVEL, __FILE__, __LINE__, __func__ )
    
 /**
  * @def FC_LOG_MESSAGE(LOG_LEVEL,FORMAT,...)
@@ -0,0 +1,143 @@
+#pragma once
+#include <boost/asio/buffer.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/exception/exception.hpp>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace fc {
+
+  /**
+   *  @brief immutable, reference counted serialized bytes
+   *
+   *  Packs an object once so that the result can be appended to any number of gather_datastreams, e.g. one per
+   *  peer, without copying. Copies of a shared_payload share the same bytes.
+   */
+  class shared_payload {
+  public:
+    shared_payload() = default;
+
+    explicit shared_payload( std::vector<char>&& bytes )
+    : _data( std::make_shared<const std::vector<char>>( std::move( bytes ) ) ) {}
+
+    template <typename T>
+    static shared_payload pack( const T& v ) {
+      return shared_payload( fc::raw::pack( v ) );
+    }
+
+    const char* data() const { return _data ? _data->data() : nullptr; }
+    size_t      size() const { return _data ? _data->size() : 0; }
+    bool        empty() const { return size() == 0; }
+
+    boost::asio::const_buffer buffer() const { return boost::asio::buffer( data(), size() ); }
+
+    /// number of shared_payload instances referencing the bytes
+    long use_count() const { return _data.use_count(); }
+
+  private:
+    friend class gather_datastream;
+    std::shared_ptr<const std::vector<char>> _data;
+  };
+
+  /**
+   *  @brief write-only datastream that produces a gather list for boost::asio async_write()
+   *
+   *  Bytes written with write()/put() (i.e. by fc::raw::pack) are copied into chunks of stable storage owned by
+   *  the stream. Large, already serialized data can instead be appended by reference with append(), which
+   *  adds a buffer pointing at it and keeps a shared_payload alive for as long as the stream exists.
+   *  Adjacent copied bytes are coalesced into one buffer.
+   */
+  class gather_datastream {
+  public:
+    static constexpr size_t default_chunk_size = 4096;
+
+    explicit gather_datastream( size_t chunk_size = default_chunk_size ) : _chunk_size( chunk_size ) {}
+
+    gather_datastream( gather_datastream&& ) = default;
+    gather_datastream& operator=( gather_datastream&& ) = default;
+
+    inline bool write( const char* d, size_t s ) {
+      if( !s )
+        return true;
+      if( s > _chunk_avail ) {
+        if( s > _chunk_size ) {
+          // large writes get a buffer of their own rather than splitting across chunks
+          _chunks.emplace_back( new char[s] );
+          memcpy( _chunks.back().get(), d, s );
+          add_buffer( _chunks.back().get(), s );
+          _chunk_pos = nullptr;
+          _chunk_avail = 0;
+          _coalesce = false;
+          return true;
+        }
+        new_chunk();
+      }
+      memcpy( _chunk_pos, d, s );
+      append_copied( s );
+      return true;
+    }
+
+    inline bool put( char c ) { return write( &c, 1 ); }
+
+    /// appends the payload bytes by reference; the payload stays alive as long as this stream
+    void append( const shared_payload& p ) {
+      if( p.empty() )
+        return;
+      _keep_alive.push_back( p._data );
+      add_buffer( p.data(), p.size() );
+      _coalesce = false;
+    }
+
+    /// appends bytes by reference; the caller guarantees d outlives any use of buffers()
+    void append_unowned( const char* d, size_t s ) {
+      if( !s )
+        return;
+      add_buffer( d, s );
+      _coalesce = false;
+    }
+
+    inline size_t tellp() const { return _size; }
+    inline bool   valid() const { return true; }
+    inline size_t remaining() const { return std::numeric_limits<size_t>::max() - _size; }
+
+    /// buffer sequence for boost::asio::async_write
+    const std::vector<boost::asio::const_buffer>& buffers() const { return _buffers; }
+
+  private:
+    void new_chunk() {
+      _chunks.emplace_back( new char[_chunk_size] );
+      _chunk_pos = _chunks.back().get();
+      _chunk_avail = _chunk_size;
+      _coalesce = false;
+    }
+
+    void add_buffer( const char* d, size_t s ) {
+      _buffers.emplace_back( d, s );
+      _size += s;
+    }
+
+    void append_copied( size_t s ) {
+      // copied bytes that directly follow the previous copy extend its buffer
+      if( _coalesce ) {
+        _buffers.back() = boost::asio::const_buffer( _buffers.back().data(), _buffers.back().size() + s );
+        _size += s;
+      } else {
+        add_buffer( _chunk_pos, s );
+      }
+      _chunk_pos += s;
+      _chunk_avail -= s;
+      _coalesce = true;
+    }
+
+    size_t                                              _chunk_size;
+    std::vector<std::unique_ptr<char[]>>                _chunks;
+    char*                                               _chunk_pos = nullptr;
+    size_t                                              _chunk_avail = 0;
+    size_t                                              _size = 0;
+    bool                                                _coalesce = false;
+    std::vector<boost::asio::const_buffer>              _buffers;
+    std::vector<std::shared_ptr<const std::vector<char>>> _keep_alive;
+  };
+
+} // namespace fc
@@ -11,6 +11,8 @@ namespace fc {
   class mb_datastream;
   template <uint32_t buffer_len>
   class mb_peek_datastream;
+  template <uint32_t buffer_len>
+  class mb_write_datastream;
 
   /**
    *  @brief abstraction for a message buffer that spans a chain of physical buffers
@@ -263,6 +265,12 @@ namespace fc {
      */
     mb_peek_datastream<buffer_len> create_peek_datastream();
 
+    /*
+     *  Creates an mb_write_datastream object that packs directly at the
+     *  write pointer, adding buffers to the chain as needed.
+     */
+    mb_write_datastream<buffer_len> create_write_datastream();
+
   private:
     using buffer_type = std::array<char, buffer_len>;
     using pool_type = boost::singleton_pool<message_buffer, sizeof(buffer_type)>;
@@ -349,4 +357,46 @@ namespace fc {
      return mb_peek_datastream<buffer_len>( *this );
   }
 
+  /*
+   *  @brief datastream adapter that adapts message_buffer for use with fc pack
+   *
+   *  Bytes are written at the write pointer and the write pointer is advanced,
+   *  so a message can be packed straight into an outbound buffer chain without
+   *  first packing it into a std::vector<char>.
+   */
+  template <uint32_t buffer_len>
+  class mb_write_datastream {
+  public:
+     explicit mb_write_datastream( message_buffer<buffer_len>& m ) : mb( m ) {}
+
+     inline bool write( const char* d, size_t s ) {
+        if( mb.bytes_to_write() < s )
+           mb.add_space( s - mb.bytes_to_write() );
+        while( s > 0 ) {
+           const uint32_t in_buffer = std::min<size_t>( s, buffer_len - mb.write_index().second );
+           memcpy( mb.write_ptr(), d, in_buffer );
+           mb.advance_write_ptr( in_buffer );
+           d += in_buffer;
+           s -= in_buffer;
+           written += in_buffer;
+        }
+        return true;
+     }
+
+     inline bool put( char c ) { return write( &c, 1 ); }
+
+     inline bool   valid() const { return true; }
+     /// bytes written through this datastream
+     inline size_t tellp() const { return written; }
+
+  private:
+     message_buffer<buffer_len>& mb;
+     size_t written = 0;
+  };
+
+  template <uint32_t buffer_len>
+  inline mb_write_datastream<buffer_len> message_buffer<buffer_len>::create_write_datastream() {
+     return mb_write_datastream<buffer_len>( *this );
+  }
+
 } // namespace fc
@@ -0,0 +1,230 @@
+#pragma once
+#include <boost/asio/buffer.hpp>
+#include <fc/io/datastream.hpp>
+#include <fc/exception/exception.hpp>
+#include <array>
+#include <cstring>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+namespace fc {
+  template <uint32_t capacity>
+  class ring_mb_datastream;
+
+  /**
+   *  @brief fixed capacity message buffer backed by a double mapped ring
+   *
+   *  Offers the same interface as message_buffer so that a connection can pick either, but keeps its data in
+   *  one region of capacity bytes that is mapped twice back to back. Every run of unread bytes, and every run
+   *  of free space, is therefore contiguous in memory regardless of where it wraps: async reads use a single
+   *  buffer and unpack can run over a plain datastream<const char*> without copying.
+   *
+   *  Unlike message_buffer the ring does not grow; add_space() and advance_write_ptr() throw if a message
+   *  would not fit into the capacity. capacity must be a power of two and a multiple of the page size.
+   */
+  template <uint32_t capacity>
+  class ring_message_buffer {
+  public:
+    static_assert( capacity && ( capacity & ( capacity - 1 ) ) == 0, "capacity must be a power of two" );
+
+    /*
+     *  index abstraction that references a position in the stream of bytes written to the ring.
+     */
+    typedef uint64_t index_t;
+
+    ring_message_buffer() {
+      FC_ASSERT( capacity % sysconf( _SC_PAGESIZE ) == 0, "ring capacity ${c} is not a multiple of the page size", ("c", capacity) );
+
+#if defined(__linux__)
+      int fd = memfd_create( "fc_ring_message_buffer", MFD_CLOEXEC );
+#else
+      std::string name = "/fc_ring_mb_" + std::to_string( getpid() ) + "_" + std::to_string( reinterpret_cast<uintptr_t>( this ) );
+      int fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+      if( fd != -1 )
+        shm_unlink( name.c_str() );
+#endif
+      FC_ASSERT( fd != -1, "unable to create ring buffer backing: ${e}", ("e", strerror( errno )) );
+
+      bool ok = ftruncate( fd, capacity ) == 0;
+      void* reserve = ok ? mmap( nullptr, 2 * size_t(capacity), PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) : MAP_FAILED;
+      if( reserve != MAP_FAILED ) {
+        base = static_cast<char*>( reserve );
+        ok = mmap( base, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) != MAP_FAILED &&
+             mmap( base + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) != MAP_FAILED;
+      } else {
+        ok = false;
+      }
+      const int err = errno;
+      ::close( fd );
+      if( !ok ) {
+        if( base )
+          munmap( base, 2 * size_t(capacity) );
+        base = nullptr;
+        FC_THROW_EXCEPTION( fc::exception, "unable to map ring buffer: ${e}", ("e", strerror( err )) );
+      }
+    }
+
+    ~ring_message_buffer() {
+      if( base )
+        munmap( base, 2 * size_t(capacity) );
+    }
+
+    ring_message_buffer( const ring_message_buffer& ) = delete;
+    ring_message_buffer& operator=( const ring_message_buffer& ) = delete;
+
+    /*
+     *  Returns the current read index referencing the byte that is next to be read.
+     */
+    index_t read_index() const { return read_ind; }
+
+    /*
+     *  Returns the current write index referencing the byte that is next to be written to.
+     */
+    index_t write_index() const { return write_ind; }
+
+    /*
+     *  Returns the current read pointer; bytes_to_read() bytes from here are contiguous.
+     */
+    char* read_ptr() { return get_ptr( read_ind ); }
+
+    /*
+     *  Returns the current write pointer; bytes_to_write() bytes from here are contiguous.
+     */
+    char* write_ptr() { return get_ptr( write_ind ); }
+
+    /*
+     *  The ring does not grow; only verifies that a full capacity of free space could be available.
+     */
+    void add_buffer_to_chain() {
+      add_space( capacity - bytes_to_read() );
+    }
+
+    /*
+     *  Verifies that at least bytes are available to be written, throwing if the ring is too small.
+     */
+    void add_space( uint32_t bytes ) {
+      if( bytes > bytes_to_write() ) {
+        FC_THROW_EXCEPTION( out_of_range_exception, "ring buffer of ${c} bytes cannot hold ${b} more bytes, ${r} unread",
+                            ("c", capacity)( "b", bytes )( "r", bytes_to_read() ) );
+      }
+    }
+
+    /*
+     *  Resets the message buffer to the initial state. Any unread data is discarded.
+     */
+    void reset() {
+      read_ind = 0;
+      write_ind = 0;
+    }
+
+    uint32_t bytes_to_read() const { return write_ind - read_ind; }
+
+    uint32_t bytes_to_read_from_index( const index_t& ind ) const { return write_ind - ind; }
+
+    uint32_t bytes_to_write() const { return capacity - bytes_to_read(); }
+
+    uint32_t total_bytes() const { return capacity; }
+
+    void advance_read_ptr( uint32_t bytes ) {
+      if( bytes > bytes_to_read() ) {
+        FC_THROW_EXCEPTION( out_of_range_exception, "tried to advance ${r} but only ${s} left",
+                            ("r", bytes)( "s", bytes_to_read() ) );
+      }
+      read_ind += bytes;
+      if( read_ind == write_ind )
+        reset();
+    }
+
+    void advance_write_ptr( uint32_t bytes ) {
+      add_space( bytes );
+      write_ind += bytes;
+    }
+
+    /*
+     *  Returns the single contiguous free region for boost async_read() and async_read_some().
+     */
+    std::array<boost::asio::mutable_buffer, 1> get_buffer_sequence_for_boost_async_read() {
+      return { boost::asio::buffer( write_ptr(), bytes_to_write() ) };
+    }
+
+    bool read( void* s, uint32_t size ) {
+      if( bytes_to_read() < size ) {
+        FC_THROW_EXCEPTION( out_of_range_exception, "tried to read ${r} but only ${s} left",
+                            ("r", size)( "s", bytes_to_read() ) );
+      }
+      memcpy( s, read_ptr(), size );
+      advance_read_ptr( size );
+      return true;
+    }
+
+    bool peek( void* s, uint32_t size, index_t& index ) const {
+      if( bytes_to_read_from_index( index ) < size ) {
+        FC_THROW_EXCEPTION( out_of_range_exception, "tried to peek ${r} but only ${s} left",
+                            ("r", size)( "s", bytes_to_read_from_index( index ) ) );
+      }
+      memcpy( s, get_ptr( index ), size );
+      advance_index( index, size );
+      return true;
+    }
+
+    static void advance_index( index_t& index, uint32_t bytes ) { index += bytes; }
+
+    /*
+     *  Creates a datastream that consumes from the buffer for use with fc unpack.
+     */
+    ring_mb_datastream<capacity> create_datastream();
+
+    /*
+     *  Creates a datastream over all unread bytes without consuming them. The bytes are contiguous so this is
+     *  a plain datastream<const char*>; call advance_read_ptr( ds.tellp() ) to consume what was unpacked.
+     */
+    fc::datastream<const char*> create_peek_datastream() const {
+      return fc::datastream<const char*>( get_ptr( read_ind ), bytes_to_read() );
+    }
+
+  private:
+    char* get_ptr( const index_t& index ) const {
+      return base + ( index & ( capacity - 1 ) );
+    }
+
+    char*   base = nullptr;
+    index_t read_ind = 0;
+    index_t write_ind = 0;
+  };
+
+  /*
+   *  @brief datastream adapter that consumes from a ring_message_buffer for use with fc unpack
+   *
+   *  This class supports unpack functionality but not pack.
+   */
+  template <uint32_t capacity>
+  class ring_mb_datastream {
+  public:
+    explicit ring_mb_datastream( ring_message_buffer<capacity>& m ) : mb(m) {}
+
+    inline void skip( size_t s ) { mb.advance_read_ptr( s ); }
+    inline bool read( char* d, size_t s ) {
+      if( mb.bytes_to_read() >= s ) {
+        memcpy( d, mb.read_ptr(), s );
+        mb.advance_read_ptr( s );
+        return true;
+      }
+      fc::detail::throw_datastream_range_error( "read", mb.bytes_to_read(), s - mb.bytes_to_read() );
+    }
+
+    inline bool get( unsigned char& c ) { return read( reinterpret_cast<char*>( &c ), 1 ); }
+    inline bool get( char& c ) { return read( &c, 1 ); }
+
+  private:
+    ring_message_buffer<capacity>& mb;
+  };
+
+  template <uint32_t capacity>
+  inline ring_mb_datastream<capacity> ring_message_buffer<capacity>::create_datastream() {
+    return ring_mb_datastream<capacity>( *this );
+  }
+
+} // namespace fc
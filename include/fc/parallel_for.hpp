@@ -0,0 +1,37 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace fc { namespace detail {
+
+   /// runs f(i) for i in [0, n) on up to num_threads threads, rethrowing the first exception
+   template<typename F>
+   void parallel_for( size_t n, size_t num_threads, F&& f ) {
+      num_threads = std::max<size_t>( 1, std::min( num_threads, n ) );
+      std::atomic<size_t> next{0};
+      std::vector<std::exception_ptr> errors( num_threads );
+      auto work = [&]( size_t t ) {
+         try {
+            for( size_t i = next++; i < n; i = next++ )
+               f( i );
+         } catch( ... ) {
+            errors[t] = std::current_exception();
+            next = n;
+         }
+      };
+      std::vector<std::thread> threads;
+      threads.reserve( num_threads - 1 );
+      for( size_t t = 1; t < num_threads; ++t )
+         threads.emplace_back( work, t );
+      work( 0 );
+      for( auto& t : threads )
+         t.join();
+      for( auto& e : errors )
+         if( e )
+            std::rethrow_exception( e );
+   }
+
+} } // namespace fc::detail
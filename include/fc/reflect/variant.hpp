@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/reflect/reflect.hpp>
 #include <fc/variant_object.hpp>
+#include <array>
 
 namespace fc
 {
@@ -10,6 +11,47 @@ namespace fc
    void from_variant( const variant& v, T& o );
 
 
+   namespace detail {
+      template<size_t N>
+      struct member_name_visitor {
+         std::array<const char*, N> names{};
+         size_t                     i = 0;
+
+         template<typename Member, class Class, Member (Class::*member)>
+         constexpr void operator()( const char* name ) {
+            names[i++] = name;
+         }
+      };
+
+      constexpr bool equal_member_names( const char* a, const char* b ) {
+         for( ; *a && *a == *b; ++a, ++b ) {}
+         return *a == *b;
+      }
+
+      /// true when no two reflected members of T, including those of its bases, have the same name
+      template<typename T>
+      constexpr bool has_unique_member_names() {
+         member_name_visitor<fc::reflector<T>::total_member_count> v;
+         fc::reflector<T>::visit( v );
+         for( size_t i = 0; i < v.names.size(); ++i )
+            for( size_t j = i + 1; j < v.names.size(); ++j )
+               if( equal_member_names( v.names[i], v.names[j] ) )
+                  return false;
+         return true;
+      }
+   }
+
+   /**
+    *  Key of a reflected member in variant objects. It is created once, entries made by to_variant refer to it
+    *  instead of copying the name, and variant_object::find() matches it by address.
+    */
+   template<typename Member, class Class, Member (Class::*member)>
+   const string* reflected_member_key( const char* name )
+   {
+      static const string key( name );
+      return &key;
+   }
+
    template<typename T>
    class to_variant_visitor
    {
@@ -20,19 +62,27 @@ namespace fc
          template<typename Member, class Class, Member (Class::*member)>
          void operator()( const char* name )const
          {
-            this->add(vo,name,(val.*member));
+            this->add(vo,reflected_member_key<Member,Class,member>(name),(val.*member));
          }
 
       private:
          template<typename M>
-         void add( mutable_variant_object& vo, const char* name, const std::optional<M>& v )const
+         void add( mutable_variant_object& vo, const string* key, const std::optional<M>& v )const
          { 
             if( v )
-               vo(name,*v);
+               add(vo,key,*v);
          }
          template<typename M>
-         void add( mutable_variant_object& vo, const char* name, const M& v )const
-         { vo(name,v); }
+         void add( mutable_variant_object& vo, const string* key, const M& v )const
+         {
+            // a base member hidden by a derived one is reflected twice, the later one replaces the former
+            if constexpr( unique_names )
+               vo.append_unique( key, variant( v ) );
+            else
+               vo( *key, v );
+         }
+
+         static constexpr bool unique_names = detail::has_unique_member_names<T>();
 
          mutable_variant_object& vo;
          const T& val;
@@ -49,7 +99,7 @@ namespace fc
          template<typename Member, class Class, Member (Class::*member)>
          void operator()( const char* name )const
          {
-            auto itr = vo.find(name);
+            auto itr = vo.find( *reflected_member_key<Member,Class,member>(name) );
             if( itr != vo.end() )
                from_variant( itr->value(), this->obj.*member );
          }
@@ -57,6 +107,56 @@ namespace fc
          const variant_object& vo;
    };
 
+   template<typename T>
+   class checked_from_variant_visitor : public reflector_init_visitor<T>
+   {
+      public:
+         checked_from_variant_visitor( const variant_object& _vo, T& v, from_variant_error& e )
+         :reflector_init_visitor<T>(v)
+         ,vo(_vo),err(e){}
+
+         template<typename Member, class Class, Member (Class::*member)>
+         void operator()( const char* name )const
+         {
+            if( err )
+               return;
+            const string& key = *reflected_member_key<Member,Class,member>(name);
+            auto itr = vo.find( key );
+            if( itr != vo.end() && !try_from_variant( itr->value(), this->obj.*member, err ) )
+               err.path.insert( 0, err.path.empty() || err.path[0] == '[' ? key : key + '.' );
+         }
+
+         /// only a completely converted object is initialized, a throwing reflector_init() is a conversion failure
+         void reflector_init()const
+         {
+            if( err )
+               return;
+            try {
+               const_cast<checked_from_variant_visitor*>(this)->reflector_init_visitor<T>::reflector_init();
+            } catch( ... ) {
+               err.code = from_variant_error::conversion_failed;
+               err.nested = std::current_exception();
+            }
+         }
+
+      private:
+         const variant_object& vo;
+         from_variant_error&   err;
+   };
+
+   namespace detail {
+      template<typename T>
+      bool try_from_variant_reflected( const variant& v, T& o, from_variant_error& err )
+      {
+         if( !v.is_object() ) {
+            err.code = from_variant_error::type_mismatch;
+            return false;
+         }
+         fc::reflector<T>::visit( checked_from_variant_visitor<T>( v.get_object(), o, err ) );
+         return !err;
+      }
+   }
+
    template<typename IsReflected=fc::false_type>
    struct if_enum 
    {
@@ -64,14 +164,21 @@ namespace fc
      static inline void to_variant( const T& v, fc::variant& vo ) 
      { 
          mutable_variant_object mvo;
+         mvo.reserve( fc::reflector<T>::total_member_count );
          fc::reflector<T>::visit( to_variant_visitor<T>( mvo, v ) );
          vo = fc::move(mvo);
      }
      template<typename T>
      static inline void from_variant( const fc::variant& v, T& o ) 
      { 
-         const variant_object& vo = v.get_object();
-         fc::reflector<T>::visit( from_variant_visitor<T>( vo, o ) );
+         // called by try_from_variant(), report instead of throwing
+         if( auto* ctx = detail::take_checked_from_variant( o ) ) {
+            detail::try_from_variant_reflected( v, o, *ctx->err );
+            return;
+         }
+         from_variant_error err;
+         if( !detail::try_from_variant_reflected( v, o, err ) )
+            err.rethrow( fc::get_typename<T>::name() );
      }
    };
 
@@ -11,22 +11,51 @@ namespace fc {
 template<typename Result>
 struct visitor {};
 
-template <typename variant, int32_t i = 0>
-void from_index(variant& v, int index) 
+namespace detail {
+   template<typename F, std::size_t I>
+   decltype(auto) call_with_index( F& f ) { return f( std::integral_constant<std::size_t, I>{} ); }
+
+   template<typename F, std::size_t... I>
+   decltype(auto) visit_index( std::size_t index, F& f, std::index_sequence<I...> )
+   {
+      using result_type = decltype( f( std::integral_constant<std::size_t, 0>{} ) );
+      static constexpr result_type (*table[])( F& ) = { &call_with_index<F, I>... };
+      return table[index]( f );
+   }
+}
+
+/**
+ *  Calls f( std::integral_constant<std::size_t, index>{} ) through a table of function pointers, so a runtime
+ *  index selects among N compile time alternatives with a single indirect call.
+ *  @pre index < N
+ */
+template<std::size_t N, typename F>
+decltype(auto) visit_index( std::size_t index, F&& f )
 {
-  if constexpr(i >= std::variant_size_v<variant>)
+   static_assert( N > 0 );
+   return detail::visit_index( index, f, std::make_index_sequence<N>{} );
+}
+
+/**
+ *  Replaces the value of v with a default constructed alternative number index, constructed in place,
+ *  and calls f with a reference to it. Throws assert_exception if index is out of range.
+ */
+template<typename variant, typename F>
+decltype(auto) emplace_index(variant& v, std::size_t index, F&& f)
+{
+  if( index >= std::variant_size_v<variant> )
   {
     FC_THROW_EXCEPTION(fc::assert_exception, "Provided index out of range for variant.");
   }
-  else if (index == 0)
-  {
-     auto value = variant(std::in_place_index<i>);
-     v = std::move(value); 
-  }
-  else
-  {
-     from_index<variant, i + 1>(v, index - 1);
-  }
+  return visit_index<std::variant_size_v<variant>>( index, [&]( auto i ) -> decltype(auto) {
+     return f( v.template emplace<decltype(i)::value>() );
+  } );
+}
+
+template <typename variant>
+void from_index(variant& v, std::size_t index)
+{
+  emplace_index( v, index, []( auto& ) {} );
 }
 
 template<typename VariantType, typename T, std::size_t index = 0>
@@ -78,14 +107,13 @@ template<typename... T> void to_variant( const std::variant<T...>& s, fc::varian
 
 template<typename... T> void from_variant( const fc::variant& v, std::variant<T...>& s )
 {
-  auto ar = v.get_array();
+  const auto& ar = v.get_array();
   if( ar.size() < 2 )
   {
     s = std::variant<T...>();
     return;
   }
-  from_index(s, ar[0].as_uint64());
-  std::visit( to_static_variant(ar[1]), s );
+  emplace_index( s, ar[0].as_uint64(), to_static_variant(ar[1]) );
 }
 
 template<typename... T> struct get_typename { static const char* name() { return BOOST_CORE_TYPEID(std::variant<T...>).name(); } };
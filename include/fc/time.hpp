@@ -43,12 +43,24 @@ namespace fc {
     public:
         constexpr explicit time_point( microseconds e = microseconds() ) :elapsed(e){}
         static time_point now();
+        /**
+         *  Cheaper than now() but only as precise as the kernel's timer tick, typically 1 to 4 ms, and never ahead of
+         *  now(). Reads CLOCK_REALTIME_COARSE where available and is now() elsewhere. Respects mock_time_traits.
+         *  Suited to timestamps that are only displayed; do not compare it against deadlines derived from now().
+         */
+        static time_point now_coarse();
         static constexpr time_point maximum() { return time_point( microseconds::maximum() ); }
         static constexpr time_point min() { return time_point();                      }
 
         operator fc::string()const;
         static time_point from_iso_string( const fc::string& s );
 
+        /**
+         *  Writes the same YYYY-MM-DDTHH:MM:SS.sss form as operator fc::string() into buf, null terminated.
+         *  @return number of characters written, not counting the null
+         */
+        size_t to_iso_string( char (&buf)[32] )const;
+
         constexpr const microseconds& time_since_epoch()const { return elapsed; }
         constexpr uint32_t            sec_since_epoch()const  { return elapsed.count() / 1000000; }
         constexpr bool   operator > ( const time_point& t )const                              { return elapsed._count > t.elapsed._count; }
@@ -112,6 +124,8 @@ namespace fc {
 
         fc::string to_non_delimited_iso_string()const;
         fc::string to_iso_string()const;
+        /// writes YYYY-MM-DDTHH:MM:SS into buf, null terminated; returns the number of characters written
+        size_t     to_iso_string( char (&buf)[32] )const;
 
         operator fc::string()const;
         static time_point_sec from_iso_string( const fc::string& s );
@@ -186,6 +186,7 @@ namespace fc {
   class optional_delegate<R(Args...)> : private std::function<R(Args...)> {
   public:
      using std::function<R(Args...)>::function;
+     using std::function<R(Args...)>::operator bool;
 
      auto operator()( Args... args ) const -> R {
         if (static_cast<bool>(*this)) {
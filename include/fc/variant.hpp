@@ -1,14 +1,17 @@
 #pragma once
 
 #include <deque>
+#include <exception>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <string.h> // memset
+#include <typeinfo>
 
 #include <fc/string.hpp>
 #include <fc/time.hpp>
@@ -171,6 +174,61 @@ namespace fc
    void from_variant( const fc::variant& var,  std::shared_ptr<T>& vo );
 
    typedef std::vector<fc::variant>   variants;
+
+   /**
+    *  Failure reported by try_from_variant() and variant::as_checked(): what went wrong and where, e.g.
+    *  "actions[2].account". Reporting it does not throw and does not capture a log message.
+    */
+   struct from_variant_error
+   {
+      enum code_type : uint8_t
+      {
+         none              = 0,
+         type_mismatch     = 1, ///< the variant holds a type that does not convert, e.g. an object for an integer
+         invalid_value     = 2, ///< a string that does not parse as the number expected
+         too_large         = 3, ///< more than MAX_NUM_ARRAY_ELEMENTS array elements
+         conversion_failed = 4  ///< a from_variant() without a checked counterpart threw, see nested
+      };
+
+      code_type          code = none;
+      std::string        path;
+      std::exception_ptr nested;
+
+      explicit operator bool()const { return code != none; }
+
+      /// throws what the throwing conversion of \a type_name reports for this error
+      [[noreturn]] void rethrow( const char* type_name )const;
+   };
+
+   /**
+    *  @name Non-throwing conversions
+    *
+    *  try_from_variant( v, o, err ) converts like from_variant( v, o ) but returns false and fills in \a err,
+    *  which must not hold an error yet, instead of throwing. Primitives, arrays, optionals and reflected types are
+    *  checked without exceptions; other types fall back to their from_variant() and report what it throws as
+    *  from_variant_error::conversion_failed.
+    */
+   ///@{
+   bool try_from_variant( const variant& v, int64_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, uint64_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, int32_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, uint32_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, int16_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, uint16_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, int8_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, uint8_t& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, bool& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, double& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, float& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, std::string& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, variant& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, variants& o, from_variant_error& err );
+   bool try_from_variant( const variant& v, std::vector<char>& o, from_variant_error& err );
+   template<typename T> bool try_from_variant( const variant& v, std::vector<T>& o, from_variant_error& err );
+   template<typename T> bool try_from_variant( const variant& v, std::optional<T>& o, from_variant_error& err );
+   template<typename T> bool try_from_variant( const variant& v, T& o, from_variant_error& err );
+   ///@}
+
    template<typename A, typename B>
    void to_variant( const std::pair<A,B>& t, fc::variant& v );
    template<typename A, typename B>
@@ -185,6 +243,10 @@ namespace fc
     * variant's allocate everything but strings, arrays, and objects on the
     * stack and are 'move aware' for values allcoated on the heap.
     *
+    * Heap values are reference counted: copying a variant shares them. get_array(),
+    * get_blob() and get_object() on a non-const variant first give it a private copy,
+    * so modifying through the returned reference never affects other variants.
+    *
     * Memory usage on 64 bit systems is 16 bytes and 12 bytes on 32 bit systems.
     */
    class variant
@@ -337,6 +399,19 @@ namespace fc
            from_variant( *this, v );
         }
 
+        /**
+         *  Converts like as<T>() but returns an empty optional and fills in \a err instead of throwing,
+         *  see try_from_variant().
+         */
+        template<typename T>
+        std::optional<T> as_checked( from_variant_error& err )const
+        {
+           std::optional<T> tmp( std::in_place );
+           if( try_from_variant( *this, *tmp, err ) )
+              return tmp;
+           return {};
+        }
+
         variant& operator=( variant&& v );
         variant& operator=( const variant& v );
 
@@ -694,6 +769,91 @@ namespace fc
       n = boost::multiprecision::number<T>(v.get_string());
    }
 
+   template<typename T>
+   bool try_from_variant( const variant& v, std::vector<T>& o, from_variant_error& err )
+   {
+      if( !v.is_array() ) {
+         err.code = from_variant_error::type_mismatch;
+         return false;
+      }
+      const variants& vars = v.get_array();
+      if( vars.size() > MAX_NUM_ARRAY_ELEMENTS ) {
+         err.code = from_variant_error::too_large;
+         return false;
+      }
+      o.clear();
+      o.reserve( vars.size() );
+      for( size_t i = 0; i < vars.size(); ++i ) {
+         bool ok;
+         if constexpr( std::is_same_v<T, bool> ) {
+            bool b = false;
+            ok = try_from_variant( vars[i], b, err );
+            o.push_back( b );
+         } else {
+            ok = try_from_variant( vars[i], o.emplace_back(), err );
+         }
+         if( !ok ) {
+            err.path.insert( 0, "[" + std::to_string( i ) + "]" + ( err.path.empty() || err.path[0] == '[' ? "" : "." ) );
+            return false;
+         }
+      }
+      return true;
+   }
+
+   template<typename T>
+   bool try_from_variant( const variant& v, std::optional<T>& o, from_variant_error& err )
+   {
+      if( v.is_null() ) {
+         o.reset();
+         return true;
+      }
+      o.emplace();
+      return try_from_variant( v, *o, err );
+   }
+
+   namespace detail {
+      /**
+       *  Installed by try_from_variant() for the duration of its from_variant( v, o ) call. The reflected
+       *  from_variant() of o takes it and reports into err instead of throwing; a from_variant() of the type's own
+       *  never looks at it.
+       */
+      struct checked_from_variant_context {
+         const void*           target;
+         const std::type_info* type;
+         from_variant_error*   err;
+      };
+
+      inline thread_local checked_from_variant_context* current_checked_from_variant = nullptr;
+
+      /// the context installed for o, if any; taking it hides it from the conversions nested in o
+      template<typename T>
+      checked_from_variant_context* take_checked_from_variant( T& o ) {
+         checked_from_variant_context* ctx = current_checked_from_variant;
+         if( !ctx || ctx->target != &o || *ctx->type != typeid(T) )
+            return nullptr;
+         current_checked_from_variant = nullptr;
+         return ctx;
+      }
+   }
+
+   template<typename T>
+   bool try_from_variant( const variant& v, T& o, from_variant_error& err )
+   {
+      detail::checked_from_variant_context ctx{ &o, &typeid(T), &err };
+      detail::checked_from_variant_context* prev = detail::current_checked_from_variant;
+      detail::current_checked_from_variant = &ctx;
+      try {
+         from_variant( v, o );
+      } catch( ... ) {
+         detail::current_checked_from_variant = prev;
+         err.code = from_variant_error::conversion_failed;
+         err.nested = std::current_exception();
+         return false;
+      }
+      detail::current_checked_from_variant = prev;
+      return !err;
+   }
+
    fc::variant operator + ( const fc::variant& a, const fc::variant& b );
    fc::variant operator - ( const fc::variant& a, const fc::variant& b );
    fc::variant operator * ( const fc::variant& a, const fc::variant& b );
@@ -1,6 +1,7 @@
 #pragma once
 #include <fc/variant.hpp>
 #include <fc/unique_ptr.hpp>
+#include <unordered_map>
 
 namespace fc
 {
@@ -20,33 +21,46 @@ namespace fc
    class variant_object
    {
    public:
-      /** @brief a key/value pair */
+      /**
+       *  @brief a key/value pair
+       *
+       *  The key of an entry in an object never changes: entries are not assignable outside of the objects that
+       *  hold them, so one reached through an iterator can only be changed through value() or set(). This keeps
+       *  the key index of mutable_variant_object valid.
+       */
       class entry
       {
       public:
          entry();
          entry( string k, variant v );
+         /// the entry refers to \a k instead of copying it, \a k must have static storage duration
+         entry( const string* k, variant v );
          entry( entry&& e );
          entry( const entry& e);
-         entry& operator=(const entry&);
-         entry& operator=(entry&&);
 
-         const string&        key()const;
+         const string&        key()const { return _static_key ? *_static_key : _key; }
          const variant& value()const;
          void  set( variant v );
 
          variant&       value();
 
          friend bool operator == (const entry& a, const entry& b) {
-            return a._key == b._key && a._value == b._value;
+            return a.key() == b.key() && a._value == b._value;
          }
          friend bool operator != (const entry& a, const entry& b) {
             return !(a == b);
          }
 
       private:
-         string  _key;
-         variant _value;
+         friend class variant_object;
+         friend class mutable_variant_object;
+
+         entry& operator=(const entry&);
+         entry& operator=(entry&&);
+
+         string        _key;
+         const string* _static_key = nullptr;
+         variant       _value;
       };
 
       typedef std::vector< entry >::const_iterator iterator;
@@ -181,6 +195,19 @@ namespace fc
       */
       mutable_variant_object& operator()( string key, variant var ) &;
       mutable_variant_object operator()( string key, variant var ) &&;
+
+      /**
+       *  Appends \a key and \a var without looking for an existing entry. The caller guarantees that \a key
+       *  is not present yet, e.g. because it is a member name of a reflected type.
+       */
+      mutable_variant_object& append_unique( string key, variant var );
+
+      /**
+       *  As append_unique( string, variant ), but the entry refers to \a key instead of copying it. \a key must have
+       *  static storage duration, e.g. fc::reflected_member_key().
+       */
+      mutable_variant_object& append_unique( const string* key, variant var );
+
       template<typename T>
       mutable_variant_object& operator()( string key, T&& var ) &
       {
@@ -234,7 +261,18 @@ namespace fc
       mutable_variant_object& operator=( const mutable_variant_object& );
       mutable_variant_object& operator=( const variant_object& );
    private:
+      /// objects with at least this many entries are searched through _index
+      static constexpr size_t index_threshold = 16;
+
+      /// position of the first entry with \a key, size() if there is none
+      size_t find_index( const char* key )const;
+      void   push_back( entry e );
+      /// builds _index if the object has at least index_threshold entries, drops it otherwise
+      void   rebuild_index();
+
       std::unique_ptr< std::vector< entry > > _key_value;
+      /// hash of key -> position in _key_value; kept up to date by the non-const members, so const lookups only read it
+      std::unique_ptr< std::unordered_multimap< size_t, size_t > > _index;
       friend class variant_object;
    };
    /** @ingroup Serializable */
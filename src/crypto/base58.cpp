@@ -501,6 +501,9 @@ inline bool operator>(const CBigNum& a, const CBigNum& b)  { return (BN_cmp(a.to
 
 static const char* pszBase58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
+// number of output digits produced between calls to the yield function
+static constexpr size_t base58_yield_digit_interval = 32;
+
 // Encode a byte sequence as a base58-encoded string
 inline std::string EncodeBase58(const unsigned char* pbegin, const unsigned char* pend, const fc::yield_function_t& yield)
 {
@@ -526,9 +529,10 @@ inline std::string EncodeBase58(const unsigned char* pbegin, const unsigned char
     str.reserve((pend - pbegin) * 138 / 100 + 1);
     CBigNum dv;
     CBigNum rem;
-    while (bn > bn0)
+    for (size_t digits = 0; bn > bn0; ++digits)
     {
-        yield();
+        if (digits % base58_yield_digit_interval == 0)
+            yield();
         if (!BN_div(dv.to_bignum(), rem.to_bignum(), bn.to_bignum(), bn58.to_bignum(), pctx))
             throw bignum_error("EncodeBase58 : BN_div failed");
         bn = dv;
@@ -107,13 +107,12 @@ std::string base64url_encode( const std::string& enc ) {
   return base64url_encode( (unsigned char const*)s, enc.size() );
 }
 
-std::string base64_decode_impl(std::string const& encoded_string, const char* const b64_chars) {
-  int in_len = encoded_string.size();
+template<typename Sink>
+void base64_decode_impl(const char* encoded_string, size_t in_len, const char* const b64_chars, Sink&& sink) {
   int i = 0;
   int j = 0;
-  int in_ = 0;
+  size_t in_ = 0;
   unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
 
   while (in_len-- && encoded_string[in_] != '=') {
     throw_on_nonbase64(encoded_string[in_], b64_chars);
@@ -127,7 +126,7 @@ std::string base64_decode_impl(std::string const& encoded_string, const char* co
       char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
 
       for (i = 0; (i < 3); i++)
-        ret += char_array_3[i];
+        sink(char_array_3[i]);
       i = 0;
     }
   }
@@ -143,9 +142,13 @@ std::string base64_decode_impl(std::string const& encoded_string, const char* co
     char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
     char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
 
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+    for (j = 0; (j < i - 1); j++) sink(char_array_3[j]);
   }
+}
 
+std::string base64_decode_impl(std::string const& encoded_string, const char* const b64_chars) {
+  std::string ret;
+  base64_decode_impl(encoded_string.data(), encoded_string.size(), b64_chars, [&ret](char c) { ret += c; });
   return ret;
 }
 
@@ -157,5 +160,15 @@ std::string base64url_decode(std::string const& encoded_string) {
    return base64_decode_impl(encoded_string, base64url_chars);
 }
 
+size_t base64url_decode(const char* encoded_string, size_t len, char* out, size_t out_size) {
+   size_t written = 0;
+   base64_decode_impl(encoded_string, len, base64url_chars, [&](char c) {
+      if (written < out_size)
+         out[written] = c;
+      ++written;
+   });
+   return written;
+}
+
 } // namespace fc
 
@@ -625,3 +625,13 @@ int main( int argc, char** argv )
 */
 
 #endif
+
+#include <fc/crypto/crc.hpp>
+
+namespace fc {
+
+uint32_t crc32c( const char* data, size_t len, uint32_t crc ) {
+    return ~crc32cSlicingBy8( ~crc, data, len );
+}
+
+}
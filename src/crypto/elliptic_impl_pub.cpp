@@ -323,6 +323,51 @@ namespace fc { namespace ecc {
 //      return 1 == ECDSA_verify( 0, (unsigned char*)&digest, sizeof(digest), (unsigned char*)&sig, sizeof(sig), my->_key );
 //    }
 
+    namespace detail
+    {
+        // openssl keeps the parsed key in the public_key's EC_KEY, so there is nothing more to prepare
+        class prepared_public_key_impl {};
+    }
+
+    prepared_public_key::prepared_public_key() {}
+
+    prepared_public_key::prepared_public_key( const public_key& k ) : _key( k )
+    {
+        FC_ASSERT( k.valid() );
+    }
+
+    prepared_public_key::prepared_public_key( const prepared_public_key& k ) : _key( k._key ) {}
+
+    prepared_public_key::~prepared_public_key() {}
+
+    prepared_public_key& prepared_public_key::operator=( const prepared_public_key& k )
+    {
+        _key = k._key;
+        return *this;
+    }
+
+    bool prepared_public_key::verify_ignoring_recovery_id( const fc::sha256& digest, const compact_signature& c, bool check_canonical )const
+    {
+        int nV = c.data[0];
+        if( nV<27 || nV>=35 || !_key.valid() )
+            return false;
+        if( check_canonical && !public_key::is_canonical( c ) )
+            return false;
+
+        ECDSA_SIG *sig = ECDSA_SIG_new();
+        BN_bin2bn(&c.data[1],32,sig->r);
+        BN_bin2bn(&c.data[33],32,sig->s);
+        // like recovery, ECDSA_do_verify accepts both low and high s values
+        int ok = ECDSA_do_verify( (unsigned char*)&digest, sizeof(digest), sig, _key.my->_key );
+        ECDSA_SIG_free(sig);
+        return ok == 1;
+    }
+
+    fc::sha512 private_key::get_shared_secret( const prepared_public_key& other )const
+    {
+        return get_shared_secret( other.get_public_key() );
+    }
+
     public_key::public_key( const compact_signature& c, const fc::sha256& digest, bool check_canonical )
     {
         int nV = c.data[0];
@@ -133,6 +133,120 @@ namespace fc { namespace crypto { namespace r1 {
         return ret;
     }
 
+#ifndef FC_R1_GENERIC_RECOVERY
+    namespace detail
+    {
+      /**
+       *  Everything SEC1 4.1.6 recovery needs, allocated once per thread. The group comes from
+       *  EC_GROUP_new_by_curve_name so OpenSSL's dedicated P-256 method (constant time field arithmetic and
+       *  precomputed generator tables) is used for the scalar multiplications.
+       */
+      class recovery_context
+      {
+        public:
+          recovery_context()
+          :group( EC_GROUP_new_by_curve_name( NID_X9_62_prime256v1 ) ),
+           ctx( BN_CTX_new() ),
+           R( EC_POINT_new( group ) ),
+           Q( EC_POINT_new( group ) )
+          {
+            FC_ASSERT( group && ctx && R && Q, "unable to allocate r1 recovery context" );
+            EC_GROUP_get_order( group, order, ctx );
+            BN_rshift1( halforder, order );
+            EC_GROUP_get_curve( group, field, nullptr, nullptr, ctx );
+          }
+
+          static recovery_context& get()
+          {
+            static thread_local recovery_context context;
+            return context;
+          }
+
+          public_key_data recover( const unsigned char* rs, int recid, const fc::sha256& digest, bool enforce_low_s )
+          {
+            BN_bin2bn( rs, 32, r );
+            BN_bin2bn( rs + 32, 32, s );
+            if( enforce_low_s && BN_cmp( s, halforder ) > 0 )
+              FC_THROW_EXCEPTION( exception, "invalid high s-value encountered in r1 signature" );
+
+            // x = r + (recid / 2) * order must be a valid field element
+            FC_ASSERT( BN_copy( x, order ) && BN_mul_word( x, recid / 2 ) && BN_add( x, x, r ) );
+            if( BN_cmp( x, field ) >= 0 ||
+                !EC_POINT_set_compressed_coordinates( group, R, x, recid % 2, ctx ) )
+              FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+
+            // Q = r^-1 * (s * R - e * G), digest is exactly the size of the order so no truncation is needed
+            BN_bin2bn( (const unsigned char*)&digest, sizeof(digest), e );
+            if( !BN_mod_sub( e, zero, e, order, ctx ) ||
+                !BN_mod_inverse( rr, r, order, ctx ) ||
+                !BN_mod_mul( sor, s, rr, order, ctx ) ||
+                !BN_mod_mul( eor, e, rr, order, ctx ) ||
+                !EC_POINT_mul( group, Q, eor, R, sor, ctx ) ||
+                EC_POINT_is_at_infinity( group, Q ) )
+              FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+
+            public_key_data dat;
+            size_t len = EC_POINT_point2oct( group, Q, POINT_CONVERSION_COMPRESSED,
+                                             (unsigned char*)dat.data, sizeof(dat), ctx );
+            FC_ASSERT( len == sizeof(dat) );
+            return dat;
+          }
+
+        private:
+          ec_group   group;
+          bn_ctx     ctx;
+          ec_point   R;
+          ec_point   Q;
+          ssl_bignum order, halforder, field, zero;
+          ssl_bignum r, s, x, e, rr, sor, eor;
+      };
+    }
+#endif
+
+    public_key_data recover_public_key_data( const compact_signature& c, const fc::sha256& digest, bool enforce_low_s )
+    {
+        int nV = c.data[0];
+        if (nV<27 || nV>=35)
+            FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+        if (nV >= 31)
+            nV -= 4;
+#ifdef FC_R1_GENERIC_RECOVERY
+        ecdsa_sig sig = ECDSA_SIG_new();
+        BIGNUM *r = BN_new(), *s = BN_new();
+        BN_bin2bn(&c.data[1],32,r);
+        BN_bin2bn(&c.data[33],32,s);
+        ECDSA_SIG_set0(sig, r, s);
+
+        ec_key key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+        if( enforce_low_s )
+        {
+            ssl_bignum order, halforder;
+            EC_GROUP_get_order(EC_KEY_get0_group(key), order, nullptr);
+            BN_rshift1(halforder, order);
+            if(BN_cmp(s, halforder) > 0)
+               FC_THROW_EXCEPTION( exception, "invalid high s-value encountered in r1 signature" );
+        }
+
+        public_key_data dat;
+        if (ECDSA_SIG_recover_key_GFp(key, sig, (unsigned char*)&digest, sizeof(digest), nV - 27, 0) == 1 &&
+            EC_POINT_point2oct(EC_KEY_get0_group(key), EC_KEY_get0_public_key(key), POINT_CONVERSION_COMPRESSED,
+                               (unsigned char*)dat.data, sizeof(dat), nullptr) == sizeof(dat))
+            return dat;
+        FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+#else
+        return detail::recovery_context::get().recover( &c.data[1], nV - 27, digest, enforce_low_s );
+#endif
+    }
+
+    std::vector<public_key_data> recover_public_key_data_batch( const std::vector<std::pair<compact_signature, fc::sha256>>& sigs )
+    {
+        std::vector<public_key_data> keys;
+        keys.reserve( sigs.size() );
+        for( const auto& sig : sigs )
+            keys.emplace_back( recover_public_key_data( sig.first, sig.second ) );
+        return keys;
+    }
+
     compact_signature signature_from_ecdsa(const EC_KEY* key, const public_key_data& pub_data, fc::ecdsa_sig& sig, const fc::sha256& d) {
         //We can't use ssl_bignum here; _get0() does not transfer ownership to us; _set0() does transfer ownership to fc::ecdsa_sig
         const BIGNUM *sig_r, *sig_s;
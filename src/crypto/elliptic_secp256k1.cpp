@@ -3,6 +3,7 @@
 #include <fc/crypto/base58.hpp>
 #include <fc/crypto/hmac.hpp>
 #include <fc/crypto/openssl.hpp>
+#include <fc/crypto/rand.hpp>
 #include <fc/crypto/sha512.hpp>
 
 #include <fc/fwd_impl.hpp>
@@ -26,7 +27,14 @@ namespace fc { namespace ecc {
     namespace detail
     {
         const secp256k1_context* _get_context() {
-            static secp256k1_context* ctx = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN);
+            static secp256k1_context* ctx = [] {
+                secp256k1_context* c = secp256k1_context_create(SECP256K1_CONTEXT_VERIFY | SECP256K1_CONTEXT_SIGN);
+                // blinds the signing operations; the context is only read afterwards so it is safe to share across threads
+                unsigned char seed[32];
+                fc::rand_bytes((char*)seed, sizeof(seed));
+                FC_ASSERT( secp256k1_context_randomize(c, seed) );
+                return c;
+            }();
             return ctx;
         }
 
@@ -52,6 +60,12 @@ namespace fc { namespace ecc {
                 public_key_data _key;
         };
 
+        class prepared_public_key_impl
+        {
+            public:
+                secp256k1_pubkey _key;
+        };
+
         typedef fc::array<char,37> chr37;
         chr37 _derive_message( const public_key_data& key, int i );
         fc::sha256 _left( const fc::sha512& v );
@@ -64,14 +78,9 @@ namespace fc { namespace ecc {
     static const public_key_data empty_pub;
     
 
-    fc::sha512 private_key::get_shared_secret( const public_key& other )const
+    static fc::sha512 shared_secret( const private_key_secret& priv, secp256k1_pubkey secp_pubkey )
     {
-      static const private_key_secret empty_priv;
-      FC_ASSERT( my->_key != empty_priv );
-      FC_ASSERT( other.my->_key != empty_pub );
-      secp256k1_pubkey secp_pubkey;
-      FC_ASSERT( secp256k1_ec_pubkey_parse( detail::_get_context(), &secp_pubkey, (unsigned char*)other.serialize().data, other.serialize().size() ) );
-      FC_ASSERT( secp256k1_ec_pubkey_tweak_mul( detail::_get_context(), &secp_pubkey, (unsigned char*) my->_key.data() ) );
+      FC_ASSERT( secp256k1_ec_pubkey_tweak_mul( detail::_get_context(), &secp_pubkey, (unsigned char*) priv.data() ) );
       public_key_data serialized_result;
       size_t serialized_result_sz = sizeof(serialized_result);
       secp256k1_ec_pubkey_serialize(detail::_get_context(), (unsigned char*)&serialized_result.data, &serialized_result_sz, &secp_pubkey, SECP256K1_EC_COMPRESSED );
@@ -79,6 +88,59 @@ namespace fc { namespace ecc {
       return fc::sha512::hash( serialized_result.begin() + 1, serialized_result.size() - 1 );
     }
 
+    fc::sha512 private_key::get_shared_secret( const public_key& other )const
+    {
+      static const private_key_secret empty_priv;
+      FC_ASSERT( my->_key != empty_priv );
+      FC_ASSERT( other.my->_key != empty_pub );
+      secp256k1_pubkey secp_pubkey;
+      FC_ASSERT( secp256k1_ec_pubkey_parse( detail::_get_context(), &secp_pubkey, (unsigned char*)other.my->_key.data, other.my->_key.size() ) );
+      return shared_secret( my->_key, secp_pubkey );
+    }
+
+    fc::sha512 private_key::get_shared_secret( const prepared_public_key& other )const
+    {
+      static const private_key_secret empty_priv;
+      FC_ASSERT( my->_key != empty_priv );
+      FC_ASSERT( other._key.valid() );
+      return shared_secret( my->_key, other.my->_key );
+    }
+
+    prepared_public_key::prepared_public_key() {}
+
+    prepared_public_key::prepared_public_key( const public_key& k ) : _key( k )
+    {
+      FC_ASSERT( k.valid() );
+      FC_ASSERT( secp256k1_ec_pubkey_parse( detail::_get_context(), &my->_key, (unsigned char*)k.my->_key.data, k.my->_key.size() ),
+                 "invalid public key" );
+    }
+
+    prepared_public_key::prepared_public_key( const prepared_public_key& k ) : _key( k._key ), my( k.my ) {}
+
+    prepared_public_key::~prepared_public_key() {}
+
+    prepared_public_key& prepared_public_key::operator=( const prepared_public_key& k )
+    {
+      _key = k._key;
+      my = k.my;
+      return *this;
+    }
+
+    bool prepared_public_key::verify_ignoring_recovery_id( const fc::sha256& digest, const compact_signature& c, bool check_canonical )const
+    {
+      int nV = c.data[0];
+      if( nV<27 || nV>=35 || !_key.valid() )
+        return false;
+      if( check_canonical && !public_key::is_canonical( c ) )
+        return false;
+
+      secp256k1_ecdsa_signature secp_sig;
+      if( !secp256k1_ecdsa_signature_parse_compact( detail::_get_context(), &secp_sig, (unsigned char*)c.begin() + 1 ) )
+        return false;
+      // secp256k1_ecdsa_verify only accepts low s values while recovery accepts both
+      secp256k1_ecdsa_signature_normalize( detail::_get_context(), &secp_sig, &secp_sig );
+      return secp256k1_ecdsa_verify( detail::_get_context(), &secp_sig, (unsigned char*)digest.data(), &my->_key ) == 1;
+    }
 
     public_key::public_key() {}
 
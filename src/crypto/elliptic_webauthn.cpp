@@ -1,6 +1,7 @@
 #include <fc/crypto/elliptic_webauthn.hpp>
 #include <fc/crypto/elliptic_r1.hpp>
 #include <fc/crypto/base58.hpp>
+#include <fc/crypto/base64.hpp>
 #include <fc/crypto/openssl.hpp>
 
 #include <fc/fwd_impl.hpp>
@@ -12,16 +13,18 @@
 #include "rapidjson/reader.h"
 
 #include <string>
+#include <string_view>
 
 namespace fc { namespace crypto { namespace webauthn {
 
 namespace detail {
 using namespace std::literals;
 
+//values point into the buffer being parsed in-situ, so they are only valid as long as that buffer is
 struct webauthn_json_handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, webauthn_json_handler> {
-   std::string found_challenge;
-   std::string found_origin;
-   std::string found_type;
+   std::string_view found_challenge;
+   std::string_view found_origin;
+   std::string_view found_type;
 
    enum parse_stat_t {
       EXPECT_FIRST_OBJECT_START,
@@ -72,15 +75,15 @@ struct webauthn_json_handler : public rapidjson::BaseReaderHandler<rapidjson::UT
          case EXPECT_FIRST_OBJECT_KEY:
             return false;
          case EXPECT_CHALLENGE_VALUE:
-            found_challenge = std::string(str, length);
+            found_challenge = std::string_view(str, length);
             current_state = EXPECT_FIRST_OBJECT_KEY;
             return true;
          case EXPECT_ORIGIN_VALUE:
-            found_origin = std::string(str, length);
+            found_origin = std::string_view(str, length);
             current_state = EXPECT_FIRST_OBJECT_KEY;
             return true;
          case EXPECT_TYPE_VALUE:
-            found_type = std::string(str, length);
+            found_type = std::string_view(str, length);
             current_state = EXPECT_FIRST_OBJECT_KEY;
             return true;
          case EXPECT_FIRST_OBJECT_DONTCARE_VALUE:
@@ -183,24 +186,39 @@ struct webauthn_json_handler : public rapidjson::BaseReaderHandler<rapidjson::UT
       }
    }
 };
+
+//reused by every recovery on a thread so that parsing the client JSON does not allocate once warmed up
+struct parse_context {
+   rapidjson::Reader reader;
+   std::string       client_json;
+
+   static parse_context& get() {
+      static thread_local parse_context context;
+      return context;
+   }
+};
 } //detail
 
 
 public_key::public_key(const signature& c, const fc::sha256& digest, bool) {
+   detail::parse_context& context = detail::parse_context::get();
+   context.client_json.assign(c.client_json);
    detail::webauthn_json_handler handler;
-   detail::rapidjson::Reader reader;
-   detail::rapidjson::StringStream ss(c.client_json.c_str());
-   FC_ASSERT(reader.Parse<detail::rapidjson::kParseIterativeFlag>(ss, handler), "Failed to parse client data JSON");
+   detail::rapidjson::InsituStringStream ss(context.client_json.data());
+   FC_ASSERT(context.reader.Parse<detail::rapidjson::kParseIterativeFlag | detail::rapidjson::kParseInsituFlag>(ss, handler),
+             "Failed to parse client data JSON");
 
    FC_ASSERT(handler.found_type == "webauthn.get", "webauthn signature type not an assertion");
 
-   std::string challenge_bytes = fc::base64url_decode(handler.found_challenge);
-   FC_ASSERT(fc::sha256(challenge_bytes.data(), challenge_bytes.size()) == digest, "Wrong webauthn challenge");
+   //decode into a stack buffer; anything that is not exactly a sha256 is rejected by the sha256 constructor below
+   char challenge_bytes[sizeof(fc::sha256)];
+   size_t challenge_size = fc::base64url_decode(handler.found_challenge.data(), handler.found_challenge.size(),
+                                                challenge_bytes, sizeof(challenge_bytes));
+   FC_ASSERT(fc::sha256(challenge_bytes, challenge_size) == digest, "Wrong webauthn challenge");
 
-   char required_origin_scheme[] = "https://";
-   size_t https_len = strlen(required_origin_scheme);
-   FC_ASSERT(handler.found_origin.compare(0, https_len, required_origin_scheme) == 0, "webauthn origin must begin with https://");
-   rpid = handler.found_origin.substr(https_len, handler.found_origin.rfind(':')-https_len);
+   constexpr std::string_view required_origin_scheme = "https://";
+   FC_ASSERT(handler.found_origin.compare(0, required_origin_scheme.size(), required_origin_scheme) == 0, "webauthn origin must begin with https://");
+   rpid = handler.found_origin.substr(required_origin_scheme.size(), handler.found_origin.rfind(':')-required_origin_scheme.size());
 
    constexpr static size_t min_auth_data_size = 37;
    FC_ASSERT(c.auth_data.size() >= min_auth_data_size, "auth_data not as large as required");
@@ -220,27 +238,19 @@ public_key::public_key(const signature& c, const fc::sha256& digest, bool) {
    e.write(client_data_hash.data(), client_data_hash.data_size());
    fc::sha256 signed_digest = e.result();
 
-   //quite a bit of this copied from elliptic_r1, can probably commonize
+   //webauthn only allows compressed keys and, unlike r1::public_key, does not require a low s value
    int nV = c.compact_signature.data[0];
    if (nV<31 || nV>=35)
       FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
-   ecdsa_sig sig = ECDSA_SIG_new();
-   BIGNUM *r = BN_new(), *s = BN_new();
-   BN_bin2bn(&c.compact_signature.data[1],32,r);
-   BN_bin2bn(&c.compact_signature.data[33],32,s);
-   ECDSA_SIG_set0(sig, r, s);
-
-   fc::ec_key key = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
-   nV -= 4;
-
-   if (r1::ECDSA_SIG_recover_key_GFp(key, sig, (uint8_t*)signed_digest.data(), signed_digest.data_size(), nV - 27, 0) == 1) {
-      const EC_POINT* point = EC_KEY_get0_public_key(key);
-      const EC_GROUP* group = EC_KEY_get0_group(key);
-      size_t sz = EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, (uint8_t*)public_key_data.data, public_key_data.size(), NULL);
-      if(sz == public_key_data.size())
-         return;
-   }
-   FC_THROW_EXCEPTION( exception, "unable to reconstruct public key from signature" );
+   public_key_data = r1::recover_public_key_data(c.compact_signature, signed_digest, false);
+}
+
+std::vector<public_key> recover_public_key_batch(const std::vector<std::pair<signature, fc::sha256>>& sigs) {
+   std::vector<public_key> keys;
+   keys.reserve(sigs.size());
+   for(const auto& sig : sigs)
+      keys.emplace_back(sig.first, sig.second);
+   return keys;
 }
 
 void public_key::post_init() {
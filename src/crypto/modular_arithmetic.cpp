@@ -1,19 +1,152 @@
 #include <gmp.h>
 #include <fc/crypto/modular_arithmetic.hpp>
-#include <algorithm>
 
 namespace fc {
 
+    namespace detail {
+        static bytes export_big_endian(const mpz_t value, size_t size) {
+            auto output = bytes(size, '\0');
+            // write big-endian directly into the tail of the modulus sized buffer
+            size_t count = mpz_sgn(value) == 0 ? 0 : (mpz_sizeinbase(value, 2) + 7) / 8;
+            mpz_export(output.data() + (size - count), nullptr, 1, 1, 0, 0, value);
+            return output;
+        }
+
+        class modexp_context_impl {
+        public:
+            modexp_context_impl(const bytes& _modulus, bool ct)
+            : modulus_size(_modulus.size()), constant_time(ct) {
+                mpz_inits(modulus, base, exponent, result, chunk, tmp, rest, chunk_shift, nullptr);
+                if (modulus_size) {
+                    mpz_import(modulus, _modulus.size(), 1, 1, 0, 0, _modulus.data());
+                }
+                use_sec = constant_time && mpz_odd_p(modulus);
+                // result^(2^w) shifts the partial result past one exponent chunk
+                mpz_setbit(chunk_shift, modexp_context::yield_chunk_bits);
+            }
+
+            ~modexp_context_impl() {
+                mpz_clears(modulus, base, exponent, result, chunk, tmp, rest, chunk_shift, nullptr);
+            }
+
+            static void import(mpz_t dst, const bytes& src) {
+                if (src.size()) {
+                    mpz_import(dst, src.size(), 1, 1, 0, 0, src.data());
+                } else {
+                    mpz_set_ui(dst, 0);
+                }
+            }
+
+            // mpz_powm_sec requires a positive exponent and an odd modulus
+            void powm(mpz_t r, const mpz_t b, const mpz_t e) {
+                if (use_sec && mpz_sgn(e) > 0) {
+                    mpz_powm_sec(r, b, e, modulus);
+                } else {
+                    mpz_powm(r, b, e, modulus);
+                }
+            }
+
+            void compute(const yield_function_t& yield) {
+                const size_t w = modexp_context::yield_chunk_bits;
+                const size_t exp_bits = mpz_sizeinbase(exponent, 2);
+                if (!yield || exp_bits <= w) {
+                    powm(result, base, exponent);
+                    return;
+                }
+
+                // Split the exponent into w-bit chunks with digits in [1, 2^w] rather than [0, 2^w), so that no chunk
+                // is zero and every chunk goes through mpz_powm_sec when constant_time is set. The digits are those
+                // of rest = exponent - sum(2^(w*i)), each plus one.
+                size_t num_chunks = 0;
+                mpz_set(tmp, exponent);
+                mpz_set_ui(chunk, 0);
+                while (mpz_sgn(tmp) > 0) {
+                    mpz_setbit(chunk, num_chunks * w);
+                    mpz_sub_ui(tmp, tmp, 1);
+                    mpz_tdiv_q_2exp(tmp, tmp, w);
+                    ++num_chunks;
+                }
+                mpz_sub(rest, exponent, chunk);
+
+                // left-to-right over the chunks: result = result^(2^w) * base^digit
+                mpz_set_ui(result, 1);
+                for (size_t i = num_chunks; i-- > 0; ) {
+                    if (i + 1 != num_chunks) {
+                        powm(result, result, chunk_shift);
+                    }
+                    mpz_tdiv_q_2exp(chunk, rest, i * w);
+                    mpz_tdiv_r_2exp(chunk, chunk, w);
+                    mpz_add_ui(chunk, chunk, 1);
+                    powm(tmp, base, chunk);
+                    mpz_mul(result, result, tmp);
+                    mpz_mod(result, result, modulus);
+                    yield();
+                }
+            }
+
+            bytes export_result() {
+                return export_big_endian(result, modulus_size);
+            }
+
+            std::variant<modular_arithmetic_error, bytes> modexp(const bytes& _base, const yield_function_t& yield) {
+                if (modulus_size == 0) {
+                    return modular_arithmetic_error::modulus_len_zero;
+                }
+                if (mpz_sgn(modulus) == 0) {
+                    return bytes(modulus_size, '\0');
+                }
+                import(base, _base);
+                compute(yield);
+                return export_result();
+            }
+
+            const size_t modulus_size;
+            const bool   constant_time;
+            bool         use_sec = false;
+            mpz_t        modulus, base, exponent, result, chunk, tmp, rest, chunk_shift;
+        };
+    }
+
+    modexp_context::modexp_context(const bytes& _modulus, bool constant_time)
+    : my(new detail::modexp_context_impl(_modulus, constant_time)) {}
+
+    modexp_context::~modexp_context() = default;
+
+    std::variant<modular_arithmetic_error, bytes> modexp_context::modexp(const bytes& _base, const bytes& _exponent,
+                                                                         const yield_function_t& yield)
+    {
+        my->import(my->exponent, _exponent);
+        return my->modexp(_base, yield);
+    }
+
+    std::variant<modular_arithmetic_error, std::vector<bytes>> modexp_context::modexp_batch(const std::vector<bytes>& _bases,
+                                                                                            const bytes& _exponent,
+                                                                                            const yield_function_t& yield)
+    {
+        if (my->modulus_size == 0) {
+            return modular_arithmetic_error::modulus_len_zero;
+        }
+
+        my->import(my->exponent, _exponent);
+
+        std::vector<bytes> results;
+        results.reserve(_bases.size());
+        for (const auto& b : _bases) {
+            results.emplace_back(std::get<bytes>(my->modexp(b, yield)));
+            yield();
+        }
+        return results;
+    }
+
     std::variant<modular_arithmetic_error, bytes> modexp(const bytes& _base, const bytes& _exponent, const bytes& _modulus)
     {
         if (_modulus.size() == 0) {
             return modular_arithmetic_error::modulus_len_zero;
         }
 
-        auto output = bytes(_modulus.size(), '\0');
-
-        mpz_t base, exponent, modulus;
-        mpz_inits(base, exponent, modulus, nullptr);
+        // one-off calls skip modexp_context and its heap allocated state
+        mpz_t base, exponent, modulus, result;
+        mpz_inits(base, exponent, modulus, result, nullptr);
 
         if (_base.size()) {
             mpz_import(base, _base.size(), 1, 1, 0, 0, _base.data());
@@ -25,19 +158,10 @@ namespace fc {
 
         mpz_import(modulus, _modulus.size(), 1, 1, 0, 0, _modulus.data());
 
-        if (mpz_sgn(modulus) == 0) {
-            mpz_clears(base, exponent, modulus, nullptr);
-            return output;
+        if (mpz_sgn(modulus) != 0) {
+            mpz_powm(result, base, exponent, modulus);
         }
-
-        mpz_t result;
-        mpz_init(result);
-
-        mpz_powm(result, base, exponent, modulus);
-        // export as little-endian
-        mpz_export(output.data(), nullptr, -1, 1, 0, 0, result);
-        // and convert to big-endian
-        std::reverse(output.begin(), output.end());
+        auto output = detail::export_big_endian(result, _modulus.size());
 
         mpz_clears(base, exponent, modulus, result, nullptr);
 
@@ -32,20 +32,48 @@ namespace fc
       class exception_impl
       {
          public:
+            // FC_DECLARE_DERIVED_EXCEPTION types pass their name and what as literals, which are referenced
+            // rather than copied; any other name or what is owned by _name / _what
+            const char*     _static_name = nullptr;
+            const char*     _static_what = nullptr;
             std::string     _name;
             std::string     _what;
             int64_t         _code;
             log_messages    _elog;
+
+            const char* name()const { return _static_name ? _static_name : _name.c_str(); }
+            const char* what()const { return _static_what ? _static_what : _what.c_str(); }
+
+            void set( int64_t code, const std::string& name_value, const std::string& what_value ) {
+               _code = code;
+               _static_name = nullptr;
+               _static_what = nullptr;
+               _name = name_value;
+               _what = what_value;
+            }
+            void set( int64_t code, exception::static_text name_value, exception::static_text what_value ) {
+               _code = code;
+               _static_name = name_value.str;
+               _static_what = what_value.str;
+            }
       };
+
+      // enough for a throw and a few levels of FC_RETHROW_EXCEPTIONS without growing
+      constexpr size_t initial_log_capacity = 4;
    }
    exception::exception( log_messages&& msgs, int64_t code,
                                     const std::string& name_value,
                                     const std::string& what_value )
    :my( new detail::exception_impl() )
    {
-      my->_code = code;
-      my->_what = what_value;
-      my->_name = name_value;
+      my->set( code, name_value, what_value );
+      my->_elog = fc::move(msgs);
+   }
+
+   exception::exception( log_messages&& msgs, int64_t code, static_text name_value, static_text what_value )
+   :my( new detail::exception_impl() )
+   {
+      my->set( code, name_value, what_value );
       my->_elog = fc::move(msgs);
    }
 
@@ -56,9 +84,7 @@ namespace fc
       const std::string& what_value )
    :my( new detail::exception_impl() )
    {
-      my->_code = code;
-      my->_what = what_value;
-      my->_name = name_value;
+      my->set( code, name_value, what_value );
       my->_elog = msgs;
    }
 
@@ -95,9 +121,13 @@ namespace fc
                          const std::string& what_value )
    :my( new detail::exception_impl() )
    {
-      my->_code = code;
-      my->_what = what_value;
-      my->_name = name_value;
+      my->set( code, name_value, what_value );
+   }
+
+   exception::exception( int64_t code, static_text name_value, static_text what_value )
+   :my( new detail::exception_impl() )
+   {
+      my->set( code, name_value, what_value );
    }
 
    exception::exception( log_message&& msg,
@@ -106,9 +136,16 @@ namespace fc
                          const std::string& what_value )
    :my( new detail::exception_impl() )
    {
-      my->_code = code;
-      my->_what = what_value;
-      my->_name = name_value;
+      my->set( code, name_value, what_value );
+      my->_elog.reserve( detail::initial_log_capacity );
+      my->_elog.push_back( fc::move( msg ) );
+   }
+
+   exception::exception( log_message&& msg, int64_t code, static_text name_value, static_text what_value )
+   :my( new detail::exception_impl() )
+   {
+      my->set( code, name_value, what_value );
+      my->_elog.reserve( detail::initial_log_capacity );
       my->_elog.push_back( fc::move( msg ) );
    }
    exception::exception( const exception& c )
@@ -117,8 +154,8 @@ namespace fc
    exception::exception( exception&& c )
    :my( fc::move(c.my) ){}
 
-   const char*  exception::name()const throw() { return my->_name.c_str(); }
-   const char*  exception::what()const noexcept { return my->_what.c_str(); }
+   const char*  exception::name()const throw() { return my->name(); }
+   const char*  exception::what()const noexcept { return my->what(); }
    int64_t      exception::code()const throw() { return my->_code;         }
 
    exception::~exception(){}
@@ -138,10 +175,14 @@ namespace fc
          ll.my->_elog =  obj["stack"].as<log_messages>();
       if( obj.contains( "code" ) )
          ll.my->_code = obj["code"].as_int64();
-      if( obj.contains( "name" ) )
+      if( obj.contains( "name" ) ) {
+         ll.my->_static_name = nullptr;
          ll.my->_name = obj["name"].as_string();
-      if( obj.contains( "message" ) )
+      }
+      if( obj.contains( "message" ) ) {
+         ll.my->_static_what = nullptr;
          ll.my->_what = obj["message"].as_string();
+      }
    }
 
    const log_messages&   exception::get_log()const { return my->_elog; }
@@ -167,7 +208,7 @@ namespace fc
          } catch( ... ) {
             ss << "<- exception in to_detail_string.";
          }
-         ss << " " << my->_name << ": " << my->_what << "\n";
+         ss << " " << my->name() << ": " << my->what() << "\n";
          for( auto itr = my->_elog.begin(); itr != my->_elog.end(); ++itr ) {
             try {
                ss << itr->get_message() << "\n"; //fc::format_string( itr->get_format(), itr->get_data() ) <<"\n";
@@ -198,7 +239,7 @@ namespace fc
       const auto deadline = fc::time_point::now() + format_time_limit;
       std::stringstream ss;
       try {
-         ss << my->_what;
+         ss << my->what();
          try {
             ss << " (" << variant( my->_code ).as_string() << ")\n";
          } catch( std::bad_alloc& ) {
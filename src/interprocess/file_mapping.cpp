@@ -34,6 +34,17 @@ namespace fc {
     my->flush(); 
   }
 
+  bool mapped_region::advise( advice_t a )
+  {
+    switch( a ) {
+      case advice_sequential: return my->advise( boost::interprocess::mapped_region::advice_sequential );
+      case advice_random:     return my->advise( boost::interprocess::mapped_region::advice_random );
+      case advice_willneed:   return my->advise( boost::interprocess::mapped_region::advice_willneed );
+      case advice_dontneed:   return my->advise( boost::interprocess::mapped_region::advice_dontneed );
+      default:                return my->advise( boost::interprocess::mapped_region::advice_normal );
+    }
+  }
+
   size_t mapped_region::get_size() const 
   {
     return my->get_size();
@@ -22,9 +22,9 @@ namespace fc
     template<typename T, json::parse_type parser_type> variants arrayFromStream( T& in, uint32_t max_depth );
     template<typename T, json::parse_type parser_type> variant number_from_stream( T& in );
     template<typename T> variant token_from_stream( T& in );
-    template<typename T> void to_stream( T& os, const variants& a, const json::yield_function_t& yield, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant_object& o, const json::yield_function_t& yield, json::output_formatting format );
-    template<typename T> void to_stream( T& os, const variant& v, const json::yield_function_t& yield, json::output_formatting format );
+    template<typename T, typename Yield> void to_stream( T& os, const variants& a, Yield& yield, json::output_formatting format );
+    template<typename T, typename Yield> void to_stream( T& os, const variant_object& o, Yield& yield, json::output_formatting format );
+    template<typename T, typename Yield> void to_stream( T& os, const variant& v, Yield& yield, json::output_formatting format );
     std::string pretty_print( const std::string& v, uint8_t indent );
 }
 
@@ -492,7 +492,8 @@ namespace fc
     *  Escapes Control sequence Introducer 0x9b to \u009b
     *  All other characters unmolested.
     */
-   std::string escape_string( const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars )
+   template<typename Yield>
+   std::string escape_string_impl( const std::string_view& str, Yield& yield, bool escape_control_chars )
    {
       string r;
       const auto init_size = str.size();
@@ -569,11 +570,18 @@ namespace fc
          }
       }
 
-      return is_valid_utf8( r ) ? r : prune_invalid_utf8( r );
+      if( is_valid_utf8( r ) )
+         return r;
+      return prune_invalid_utf8( r );
    }
 
-   template<typename T>
-   void to_stream( T& os, const variants& a, const json::yield_function_t& yield, const json::output_formatting format )
+   std::string escape_string( const std::string_view& str, const json::yield_function_t& yield, bool escape_control_chars )
+   {
+      return escape_string_impl( str, yield, escape_control_chars );
+   }
+
+   template<typename T, typename Yield>
+   void to_stream( T& os, const variants& a, Yield& yield, const json::output_formatting format )
    {
       yield(os.tellp());
       os << '[';
@@ -589,8 +597,8 @@ namespace fc
       os << ']';
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant_object& o, const json::yield_function_t& yield, const json::output_formatting format )
+   template<typename T, typename Yield>
+   void to_stream( T& os, const variant_object& o, Yield& yield, const json::output_formatting format )
    {
        yield(os.tellp());
        os << '{';
@@ -598,7 +606,7 @@ namespace fc
 
        while( itr != o.end() )
        {
-          os << '"' << escape_string( itr->key(), yield ) << '"';
+          os << '"' << escape_string_impl( itr->key(), yield, true ) << '"';
           os << ':';
           to_stream( os, itr->value(), yield, format );
           ++itr;
@@ -608,8 +616,8 @@ namespace fc
        os << '}';
    }
 
-   template<typename T>
-   void to_stream( T& os, const variant& v, const json::yield_function_t& yield, const json::output_formatting format )
+   template<typename T, typename Yield>
+   void to_stream( T& os, const variant& v, Yield& yield, const json::output_formatting format )
    {
       yield(os.tellp());
       switch( v.get_type() )
@@ -649,10 +657,10 @@ namespace fc
               os << v.as_string();
               return;
          case variant::string_type:
-              os << '"' << escape_string( v.get_string(), yield ) << '"';
+              os << '"' << escape_string_impl( v.get_string(), yield, true ) << '"';
               return;
          case variant::blob_type:
-              os << '"' << escape_string( v.as_string(), yield ) << '"';
+              os << '"' << escape_string_impl( v.as_string(), yield, true ) << '"';
               return;
          case variant::array_type:
            {
@@ -679,6 +687,15 @@ namespace fc
       return ss.str();
    }
 
+   std::string   json::to_string( const variant& v, const fc::time_point& deadline, const json::output_formatting format, const uint64_t max_len )
+   {
+      deadline_yield yield( deadline, max_len );
+      std::stringstream ss;
+      fc::to_stream( ss, v, yield, format );
+      yield(ss.tellp());
+      return ss.str();
+   }
+
    std::string pretty_print( const std::string& v, const uint8_t indent ) {
       int level = 0;
       std::stringstream ss;
@@ -778,6 +795,11 @@ namespace fc
       return pretty_print( std::move( s ), 2);
    }
 
+   std::string json::to_pretty_string( const variant& v, const fc::time_point& deadline, const json::output_formatting format, const uint64_t max_len ) {
+      auto s = to_string(v, deadline, format, max_len);
+      return pretty_print( std::move( s ), 2);
+   }
+
    bool json::save_to_file( const variant& v, const fc::path& fi, const bool pretty, const json::output_formatting format )
    {
       if( pretty ) {
@@ -787,7 +809,7 @@ namespace fc
          return o.good();
       } else {
          std::ofstream o(fi.generic_string().c_str());
-         const auto yield = [&](size_t s) {
+         auto yield = [](size_t s) {
             // no limitation
          };
          fc::to_stream( o, v, yield, format );
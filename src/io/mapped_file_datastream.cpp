@@ -0,0 +1,90 @@
+#include <fc/io/mapped_file_datastream.hpp>
+#include <fc/io/raw.hpp>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace fc {
+
+   mapped_file_datastream::mapped_file_datastream( const fc::path& file, advice_t access, size_t window_size )
+   : _access( access )
+   , _window_size( window_size ? ( window_size + window_alignment - 1 ) & ~( window_alignment - 1 ) : 0 )
+   , _size( fc::file_size( file ) )
+   {
+      if( _size == 0 )
+         return; // nothing to map, every read throws datastream_range_error
+      _mapping = std::make_unique<fc::file_mapping>( file.generic_string().c_str(), fc::read_only );
+      map_window( 0, 0 );
+   }
+
+   mapped_file_datastream::~mapped_file_datastream() = default;
+
+   void mapped_file_datastream::map_window( size_t pos, size_t need ) {
+      size_t begin = 0;
+      size_t len = _size;
+      if( _window_size && _window_size < _size ) {
+         begin = pos & ~( window_alignment - 1 );
+         if( pos + need > begin + _window_size ) {
+            // fall back to page alignment so that a view straddling a huge page boundary still fits
+            const size_t page_size = sysconf( _SC_PAGESIZE );
+            begin = pos & ~( page_size - 1 );
+         }
+         len = std::min( _window_size, _size - begin );
+      }
+
+      _win_addr = nullptr;
+      _win_begin = _win_len = 0;
+      _region.reset();
+      _region = std::make_unique<fc::mapped_region>( *_mapping, fc::read_only, begin, len );
+      _region->advise( _access );
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      // best effort; only honoured for filesystems with large folio / read-only THP support
+      madvise( _region->get_address(), _region->get_size(), MADV_HUGEPAGE );
+#endif
+
+      _win_addr = static_cast<const char*>( _region->get_address() );
+      _win_begin = begin;
+      _win_len = _region->get_size();
+   }
+
+   bool mapped_file_datastream::read_slow( char* d, size_t s ) {
+      if( _pos > _size || s > _size - _pos )
+         detail::throw_datastream_range_error( "read", _size, int64_t( s - remaining() ) );
+
+      // only reached in windowed mode, or after seeking backwards out of the window
+      while( s ) {
+         if( _pos < _win_begin || _pos >= _win_begin + _win_len )
+            map_window( _pos, 0 );
+         size_t n = std::min( s, _win_begin + _win_len - _pos );
+         memcpy( d, _win_addr + ( _pos - _win_begin ), n );
+         d += n;
+         s -= n;
+         _pos += n;
+      }
+      return true;
+   }
+
+   const char* mapped_file_datastream::read_view( size_t s ) {
+      if( _pos > _size || s > _size - _pos )
+         detail::throw_datastream_range_error( "read_view", _size, int64_t( s - remaining() ) );
+      if( s == 0 )
+         return _win_addr;
+
+      if( _pos < _win_begin || _pos + s > _win_begin + _win_len ) {
+         const size_t page_size = sysconf( _SC_PAGESIZE );
+         FC_ASSERT( s + ( _pos & ( page_size - 1 ) ) <= _window_size,
+                    "read_view of ${s} bytes does not fit in a mapping window of ${w} bytes", ("s", s)("w", _window_size) );
+         map_window( _pos, s );
+      }
+      const char* p = _win_addr + ( _pos - _win_begin );
+      _pos += s;
+      return p;
+   }
+
+   std::string_view mapped_file_datastream::read_bytes_view() {
+      fc::unsigned_int size;
+      fc::raw::unpack( *this, size );
+      return std::string_view( read_view( size.value ), size.value );
+   }
+
+} // namespace fc
@@ -2,7 +2,6 @@
 #include <fc/exception/exception.hpp>
 #include <fc/variant.hpp>
 #include <fc/time.hpp>
-#include <fc/filesystem.hpp>
 #include <fc/io/json.hpp>
 
 namespace fc
@@ -14,6 +13,10 @@ namespace fc
       {
          public:
             log_level level;
+            // file and method of an FC_LOG_CONTEXT call site point at its static strings and are only copied
+            // when asked for; contexts restored from a variant own theirs
+            const char*  static_file = nullptr;
+            const char*  static_method = nullptr;
             string       file;
             uint64_t     line;
             string       method;
@@ -22,8 +25,20 @@ namespace fc
             string       hostname;
             string       context;
             time_point   timestamp;
+
+            const char*  file_name()const   { return static_file ? static_file : file.c_str(); }
+            const char*  method_name()const { return static_method ? static_method : method.c_str(); }
       };
 
+      static const char* file_basename( const char* file )
+      {
+         const char* base = file;
+         for( const char* p = file; *p; ++p )
+            if( *p == '/' || *p == '\\' )
+               base = p + 1;
+         return base;
+      }
+
       class log_message_impl
       {
          public:
@@ -47,10 +62,22 @@ namespace fc
    :my( std::make_shared<detail::log_context_impl>() )
    {
       my->level       = ll;
-      my->file        = fc::path(file).filename().generic_string(); // TODO truncate filename
+      my->file        = detail::file_basename( file );
       my->line        = line;
       my->method      = method;
-      my->timestamp   = time_point::now();
+      my->timestamp   = time_point::now_coarse();
+      my->thread_name = fc::get_thread_name();
+   }
+
+   log_context::log_context( static_call_site_t, log_level ll, const char* file, uint64_t line,
+                                                                 const char* method )
+   :my( std::make_shared<detail::log_context_impl>() )
+   {
+      my->level       = ll;
+      my->static_file   = detail::file_basename( file );
+      my->line          = line;
+      my->static_method = method;
+      my->timestamp   = time_point::now_coarse();
       my->thread_name = fc::get_thread_name();
    }
 
@@ -73,7 +100,7 @@ namespace fc
 
    fc::string log_context::to_string()const
    {
-      return my->thread_name + "  " + my->file + ":" + fc::to_string(my->line) + " " + my->method;
+      return my->thread_name + "  " + my->file_name() + ":" + fc::to_string(my->line) + " " + my->method_name();
 
    }
 
@@ -165,9 +192,9 @@ namespace fc
       return "unknown";
    }
 
-   string     log_context::get_file()const       { return my->file; }
+   string     log_context::get_file()const       { return my->file_name(); }
    uint64_t   log_context::get_line_number()const { return my->line; }
-   string     log_context::get_method()const     { return my->method; }
+   string     log_context::get_method()const     { return my->method_name(); }
    string     log_context::get_thread_name()const { return my->thread_name; }
    string     log_context::get_task_name()const { return my->task_name; }
    string     log_context::get_host_name()const   { return my->hostname; }
@@ -180,9 +207,9 @@ namespace fc
    {
       mutable_variant_object o;
               o( "level",        variant(my->level)      )
-               ( "file",         my->file                )
+               ( "file",         my->file_name()         )
                ( "line",         my->line                )
-               ( "method",       my->method              )
+               ( "method",       my->method_name()       )
                ( "hostname",     my->hostname            )
                ( "thread_name",  my->thread_name         )
                ( "timestamp",    variant(my->timestamp)  );
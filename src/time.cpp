@@ -4,6 +4,8 @@
 #include <boost/chrono/system_clocks.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <sstream>
+#include <time.h>
+#include <cstring>
 #include <fc/string.hpp>
 #include <fc/exception/exception.hpp>
 
@@ -19,16 +21,141 @@ namespace fc {
      return time_point( microseconds( bch::duration_cast<bch::microseconds>( bch::system_clock::now().time_since_epoch() ).count() ) );
   }
 
+  time_point time_point::now_coarse()
+  {
+#if defined(CLOCK_REALTIME_COARSE)
+     if( UNLIKELY(mock_time_traits::is_set()) ) {
+        return mock_time_traits::fc_now();
+     }
+     timespec ts;
+     if( LIKELY(clock_gettime( CLOCK_REALTIME_COARSE, &ts ) == 0) )
+        return time_point( microseconds( int64_t( ts.tv_sec ) * 1000000 + ts.tv_nsec / 1000 ) );
+#endif
+     return now();
+  }
+
+  namespace {
+     // days since 1970-01-01 of a proleptic Gregorian date and back, after Howard Hinnant's
+     // days_from_civil / civil_from_days
+     constexpr int64_t days_from_civil( int64_t y, unsigned m, unsigned d ) {
+        y -= m <= 2;
+        const int64_t  era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = unsigned( y - era * 400 );
+        const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + int64_t( doe ) - 719468;
+     }
+
+     struct civil_date {
+        int64_t  year;
+        unsigned month;
+        unsigned day;
+     };
+
+     constexpr civil_date civil_from_days( int64_t z ) {
+        z += 719468;
+        const int64_t  era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = unsigned( z - era * 146097 );
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp  = (5 * doy + 2) / 153;
+        const unsigned d   = doy - (153 * mp + 2) / 5 + 1;
+        const unsigned m   = mp < 10 ? mp + 3 : mp - 9;
+        return { int64_t( yoe ) + era * 400 + (m <= 2), m, d };
+     }
+
+     // boost::gregorian dates, and so the boost formatting and parsing below, cover years 1400 to 9999
+     constexpr int64_t min_iso_year    = 1400;
+     constexpr int64_t max_iso_year    = 9999;
+     constexpr int64_t max_iso_seconds = days_from_civil( max_iso_year + 1, 1, 1 ) * 86400;
+
+     inline char* put_2_digits( char* p, unsigned v ) {
+        p[0] = char( '0' + v / 10 );
+        p[1] = char( '0' + v % 10 );
+        return p + 2;
+     }
+
+     /// writes YYYY-MM-DDTHH:MM:SS, or YYYYMMDDTHHMMSS when not delimited; 0 <= secs < max_iso_seconds
+     char* put_iso_string( char* p, int64_t secs, bool delimited ) {
+        const civil_date date = civil_from_days( secs / 86400 );
+        const unsigned   tod  = unsigned( secs % 86400 );
+        p = put_2_digits( p, unsigned( date.year / 100 ) );
+        p = put_2_digits( p, unsigned( date.year % 100 ) );
+        if( delimited ) *p++ = '-';
+        p = put_2_digits( p, date.month );
+        if( delimited ) *p++ = '-';
+        p = put_2_digits( p, date.day );
+        *p++ = 'T';
+        p = put_2_digits( p, tod / 3600 );
+        if( delimited ) *p++ = ':';
+        p = put_2_digits( p, tod / 60 % 60 );
+        if( delimited ) *p++ = ':';
+        return put_2_digits( p, tod % 60 );
+     }
+
+     inline bool get_digits( const char*& p, size_t n, unsigned& v ) {
+        v = 0;
+        for( size_t i = 0; i < n; ++i, ++p ) {
+           const unsigned d = unsigned( *p ) - '0';
+           if( d > 9 ) return false;
+           v = v * 10 + d;
+        }
+        return true;
+     }
+
+     inline bool get_char( const char*& p, char c ) {
+        return *p++ == c;
+     }
+
+     constexpr unsigned days_in_month( unsigned y, unsigned m ) {
+        constexpr unsigned days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return m == 2 && y % 4 == 0 && (y % 100 != 0 || y % 400 == 0) ? 29 : days[m - 1];
+     }
+
+     /**
+      *  Parses exactly YYYY-MM-DDTHH:MM:SS, or YYYYMMDDTHHMMSS when not delimited, into seconds since the epoch.
+      *  Returns false for any other form or an out of range field; the boost parser then decides whether the
+      *  string is valid, so results stay identical to it.
+      */
+     bool parse_iso_string( const char* p, size_t size, bool delimited, int64_t& secs ) {
+        if( size != (delimited ? 19u : 15u) )
+           return false;
+        unsigned y, mo, d, h, mi, s;
+        if( !get_digits( p, 4, y ) || (delimited && !get_char( p, '-' )) ||
+            !get_digits( p, 2, mo ) || (delimited && !get_char( p, '-' )) ||
+            !get_digits( p, 2, d ) || !get_char( p, 'T' ) ||
+            !get_digits( p, 2, h ) || (delimited && !get_char( p, ':' )) ||
+            !get_digits( p, 2, mi ) || (delimited && !get_char( p, ':' )) ||
+            !get_digits( p, 2, s ) )
+           return false;
+        if( y < min_iso_year || mo < 1 || mo > 12 || d < 1 || d > days_in_month( y, mo ) || h > 23 || mi > 59 || s > 59 )
+           return false;
+        secs = days_from_civil( y, mo, d ) * 86400 + h * 3600 + mi * 60 + s;
+        return true;
+     }
+
+     inline bool is_delimited_iso_string( const fc::string& s ) {
+        return s.size() >= 5 && s[4] == '-'; // http://en.wikipedia.org/wiki/ISO_8601
+     }
+  }
+
+  size_t time_point_sec::to_iso_string( char (&buf)[32] )const
+  {
+    char* end = put_iso_string( buf, sec_since_epoch(), true );
+    *end = '\0';
+    return end - buf;
+  }
+
   fc::string time_point_sec::to_non_delimited_iso_string()const
   {
-    const auto ptime = boost::posix_time::from_time_t( time_t( sec_since_epoch() ) );
-    return boost::posix_time::to_iso_string( ptime );
+    char buf[32];
+    return fc::string( buf, put_iso_string( buf, sec_since_epoch(), false ) );
   }
 
   fc::string time_point_sec::to_iso_string()const
   {
-    const auto ptime = boost::posix_time::from_time_t( time_t( sec_since_epoch() ) );
-    return boost::posix_time::to_iso_extended_string( ptime );
+    char buf[32];
+    return fc::string( buf, to_iso_string( buf ) );
   }
 
   time_point_sec::operator fc::string()const
@@ -38,19 +165,46 @@ namespace fc {
 
   time_point_sec time_point_sec::from_iso_string( const fc::string& s )
   { try {
+      const bool delimited = is_delimited_iso_string( s );
+      int64_t secs;
+      if( parse_iso_string( s.data(), s.size(), delimited, secs ) )
+         return fc::time_point_sec( secs );
+
       static boost::posix_time::ptime epoch = boost::posix_time::from_time_t( 0 );
       boost::posix_time::ptime pt;
-      if( s.size() >= 5 && s.at( 4 ) == '-' ) // http://en.wikipedia.org/wiki/ISO_8601
+      if( delimited )
           pt = boost::date_time::parse_delimited_time<boost::posix_time::ptime>( s, 'T' );
       else
           pt = boost::posix_time::from_iso_string( s );
       return fc::time_point_sec( (pt - epoch).total_seconds() );
   } FC_RETHROW_EXCEPTIONS( warn, "unable to convert ISO-formatted string to fc::time_point_sec" ) }
 
+   size_t time_point::to_iso_string( char (&buf)[32] )const
+   {
+      const auto count = elapsed.count();
+      if( count >= 0 && count / 1000000 < max_iso_seconds ) {
+         char* p = put_iso_string( buf, count / 1000000, true );
+         const unsigned msec = unsigned( count % 1000000 / 1000 );
+         *p++ = '.';
+         *p++ = char( '0' + msec / 100 );
+         p = put_2_digits( p, msec % 100 );
+         *p = '\0';
+         return p - buf;
+      }
+      const fc::string s = *this;
+      const size_t size = std::min( s.size(), sizeof(buf) - 1 );
+      memcpy( buf, s.data(), size );
+      buf[size] = '\0';
+      return size;
+   }
+
    time_point::operator fc::string()const
    {
       auto count = elapsed.count();
-      if (count >= 0) {
+      if( count >= 0 && count / 1000000 < max_iso_seconds ) {
+         char buf[32];
+         return fc::string( buf, to_iso_string( buf ) );
+      } else if (count >= 0) {
          uint64_t secs = (uint64_t)count / 1000000ULL;
          uint64_t msec = ((uint64_t)count % 1000000ULL) / 1000ULL;
          string padded_ms = to_string((uint64_t)(msec + 1000ULL)).substr(1);
@@ -70,10 +224,25 @@ namespace fc {
       if( dot == std::string::npos )
          return time_point( time_point_sec::from_iso_string( s ) );
       else {
-         auto ms = s.substr( dot );
-         ms[0] = '1';
-         while( ms.size() < 4 ) ms.push_back('0');
-         return time_point( time_point_sec::from_iso_string( s ) ) + milliseconds( to_int64(ms) - 1000 );
+         // 1 to 3 digits of milliseconds after a canonical date and time
+         int64_t  secs;
+         unsigned ms;
+         const size_t digits = s.size() - dot - 1;
+         const char*  p = s.data() + dot + 1;
+         if( digits >= 1 && digits <= 3 && get_digits( p, digits, ms ) &&
+             parse_iso_string( s.data(), dot, is_delimited_iso_string( s ), secs ) ) {
+            for( size_t i = digits; i < 3; ++i )
+               ms *= 10;
+            // boost truncates a negative duration with a fraction towards zero
+            if( secs < 0 && ms != 0 )
+               ++secs;
+            return time_point( time_point_sec( secs ) ) + milliseconds( ms );
+         }
+
+         auto ms_str = s.substr( dot );
+         ms_str[0] = '1';
+         while( ms_str.size() < 4 ) ms_str.push_back('0');
+         return time_point( time_point_sec::from_iso_string( s ) ) + milliseconds( to_int64(ms_str) - 1000 );
       }
   } FC_RETHROW_EXCEPTIONS( warn, "unable to convert ISO-formatted string to fc::time_point" ) }
 
@@ -6,13 +6,237 @@
 #include <fc/log/logger.hpp>
 #include <fc/exception/exception.hpp>
 
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 namespace fc {
 
     inline constexpr char hex_digits[] = "0123456789abcdef";
 
+namespace {
+
+   /// true if the 32 bytes at p are all ASCII
+   inline bool is_ascii_32( const unsigned char* p ) {
+      uint64_t w[4];
+      memcpy( w, p, sizeof(w) );
+      return ( (w[0] | w[1] | w[2] | w[3]) & 0x8080808080808080ull ) == 0;
+   }
+
+   /**
+    *  Validates one code point at a time against the well-formed byte sequences of the Unicode standard
+    *  (Table 3-7). Runs of ASCII are skipped 32 bytes at a time. With RejectC1 the C1 control characters
+    *  0x80-0x9F, encoded as 0xC2 0x80-0x9F, are invalid as well.
+    */
+   template<bool RejectC1>
+   bool validate_utf8_scalar( const unsigned char* p, const unsigned char* end ) {
+      while( p != end ) {
+         if( *p < 0x80 ) {
+            while( end - p >= 32 && is_ascii_32( p ) )
+               p += 32;
+            while( p != end && *p < 0x80 )
+               ++p;
+            continue;
+         }
+         const unsigned char lead = *p;
+         size_t        len = 0;
+         unsigned char lo = 0x80, hi = 0xBF; // range of the second byte
+         if( lead >= 0xC2 && lead <= 0xDF ) {
+            len = 2;
+            if( RejectC1 && lead == 0xC2 ) lo = 0xA0;
+         }
+         else if( lead == 0xE0 )                  { len = 3; lo = 0xA0; }
+         else if( lead == 0xED )                  { len = 3; hi = 0x9F; } // surrogates
+         else if( lead >= 0xE1 && lead <= 0xEF )  { len = 3; }
+         else if( lead == 0xF0 )                  { len = 4; lo = 0x90; }
+         else if( lead >= 0xF1 && lead <= 0xF3 )  { len = 4; }
+         else if( lead == 0xF4 )                  { len = 4; hi = 0x8F; } // > 0x10FFFF
+         else return false;
+
+         if( size_t(end - p) < len || p[1] < lo || p[1] > hi )
+            return false;
+         for( size_t i = 2; i < len; ++i )
+            if( (p[i] & 0xC0) != 0x80 )
+               return false;
+         p += len;
+      }
+      return true;
+   }
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+
+#if defined(__AVX2__)
+   struct simd {
+      using reg = __m256i;
+      static constexpr size_t width = 32;
+
+      static reg  load( const unsigned char* p )     { return _mm256_loadu_si256( reinterpret_cast<const reg*>(p) ); }
+      static reg  splat( uint8_t v )                 { return _mm256_set1_epi8( char(v) ); }
+      static reg  table( const uint8_t* t )          { return _mm256_broadcastsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>(t) ) ); }
+      static reg  lookup( reg t, reg nibbles )       { return _mm256_shuffle_epi8( t, nibbles ); }
+      static reg  high_nibbles( reg v )              { return _mm256_and_si256( _mm256_srli_epi16( v, 4 ), splat( 0x0F ) ); }
+      static reg  low_nibbles( reg v )               { return _mm256_and_si256( v, splat( 0x0F ) ); }
+      static reg  and_( reg a, reg b )               { return _mm256_and_si256( a, b ); }
+      static reg  or_( reg a, reg b )                { return _mm256_or_si256( a, b ); }
+      static reg  xor_( reg a, reg b )               { return _mm256_xor_si256( a, b ); }
+      static reg  subs( reg a, reg b )               { return _mm256_subs_epu8( a, b ); }
+      static reg  eq( reg a, reg b )                 { return _mm256_cmpeq_epi8( a, b ); }
+      static bool any( reg v )                       { return !_mm256_testz_si256( v, v ); }
+      /// input shifted by N bytes, with the last N bytes of prev shifted in
+      template<int N>
+      static reg  prev( reg input, reg prev )        { return _mm256_alignr_epi8( input, _mm256_permute2x128_si256( prev, input, 0x21 ), 16 - N ); }
+   };
+#else
+   struct simd {
+      using reg = __m128i;
+      static constexpr size_t width = 16;
+
+      static reg  load( const unsigned char* p )     { return _mm_loadu_si128( reinterpret_cast<const reg*>(p) ); }
+      static reg  splat( uint8_t v )                 { return _mm_set1_epi8( char(v) ); }
+      static reg  table( const uint8_t* t )          { return load( t ); }
+      static reg  lookup( reg t, reg nibbles )       { return _mm_shuffle_epi8( t, nibbles ); }
+      static reg  high_nibbles( reg v )              { return _mm_and_si128( _mm_srli_epi16( v, 4 ), splat( 0x0F ) ); }
+      static reg  low_nibbles( reg v )               { return _mm_and_si128( v, splat( 0x0F ) ); }
+      static reg  and_( reg a, reg b )               { return _mm_and_si128( a, b ); }
+      static reg  or_( reg a, reg b )                { return _mm_or_si128( a, b ); }
+      static reg  xor_( reg a, reg b )               { return _mm_xor_si128( a, b ); }
+      static reg  subs( reg a, reg b )               { return _mm_subs_epu8( a, b ); }
+      static reg  eq( reg a, reg b )                 { return _mm_cmpeq_epi8( a, b ); }
+      static bool any( reg v )                       { return !_mm_testz_si128( v, v ); }
+      /// input shifted by N bytes, with the last N bytes of prev shifted in
+      template<int N>
+      static reg  prev( reg input, reg prev )        { return _mm_alignr_epi8( input, prev, 16 - N ); }
+   };
+#endif
+
+   /**
+    *  Vectorized validation using the lookup algorithm of Keiser and Lemire, "Validating UTF-8 In Less Than
+    *  One Instruction Per Byte". Each byte is classified by the high and low nibble of the byte before it and
+    *  the high nibble of itself; three table lookups and'ed together leave a bit set for any invalid two byte
+    *  combination. Third and fourth bytes of a sequence are checked against the leads 2 and 3 bytes back.
+    *  Blocks of 32 ASCII bytes are only checked for a sequence left incomplete by the block before them.
+    */
+   template<bool RejectC1>
+   bool validate_utf8_simd( const unsigned char* p, const unsigned char* end ) {
+      using reg = simd::reg;
+      constexpr size_t width = simd::width;
+
+      constexpr uint8_t too_short      = 1<<0; // 11______ 0_______ or 11______ 11______
+      constexpr uint8_t too_long       = 1<<1; // 0_______ 10______
+      constexpr uint8_t overlong_3     = 1<<2; // 11100000 100_____
+      constexpr uint8_t too_large      = 1<<3; // 11110100 1001____ ... 11111___ 101_____
+      constexpr uint8_t surrogate      = 1<<4; // 11101101 101_____
+      constexpr uint8_t overlong_2     = 1<<5; // 1100000_ 10______
+      constexpr uint8_t too_large_1000 = 1<<6; // 11110101 1000____ ... 11111___ 1000____
+      constexpr uint8_t overlong_4     = 1<<6; // 11110000 1000____
+      constexpr uint8_t two_conts      = 1<<7; // 10______ 10______
+      constexpr uint8_t carry          = too_short | too_long | two_conts;
+
+      static constexpr uint8_t byte_1_high[16] = {
+         too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+         two_conts, two_conts, two_conts, two_conts,
+         too_short | overlong_2,
+         too_short,
+         too_short | overlong_3 | surrogate,
+         too_short | too_large | too_large_1000 | overlong_4
+      };
+      static constexpr uint8_t byte_1_low[16] = {
+         carry | overlong_3 | overlong_2 | overlong_4,
+         carry | overlong_2,
+         carry,
+         carry,
+         carry | too_large,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000 | surrogate,
+         carry | too_large | too_large_1000,
+         carry | too_large | too_large_1000
+      };
+      static constexpr uint8_t byte_2_high[16] = {
+         too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+         too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+         too_long | overlong_2 | two_conts | overlong_3 | too_large,
+         too_long | overlong_2 | two_conts | surrogate  | too_large,
+         too_long | overlong_2 | two_conts | surrogate  | too_large,
+         too_short, too_short, too_short, too_short
+      };
+      // saturating subtraction leaves a non-zero byte for a lead in the last 3 bytes of a block whose sequence
+      // continues into the next block
+      alignas(32) static constexpr uint8_t incomplete_limits[32] = {
+         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+      };
+
+      const reg t_1_high   = simd::table( byte_1_high );
+      const reg t_1_low    = simd::table( byte_1_low );
+      const reg t_2_high   = simd::table( byte_2_high );
+      const reg incomplete = simd::load( incomplete_limits + 32 - width );
+
+      reg error           = simd::splat( 0 );
+      reg prev_input      = simd::splat( 0 );
+      reg prev_incomplete = simd::splat( 0 );
+
+      auto check_block = [&]( reg input ) {
+         const reg prev1 = simd::prev<1>( input, prev_input );
+         const reg special = simd::and_( simd::and_( simd::lookup( t_1_high, simd::high_nibbles( prev1 ) ),
+                                                     simd::lookup( t_1_low,  simd::low_nibbles( prev1 ) ) ),
+                                         simd::lookup( t_2_high, simd::high_nibbles( input ) ) );
+         // continuations are only allowed 2 and 3 bytes after 3 and 4 byte leads
+         const reg must_be_2_3_continuation = simd::or_( simd::subs( simd::prev<2>( input, prev_input ), simd::splat( 0xE0 - 0x80 ) ),
+                                                         simd::subs( simd::prev<3>( input, prev_input ), simd::splat( 0xF0 - 0x80 ) ) );
+         error = simd::or_( error, simd::xor_( simd::and_( must_be_2_3_continuation, simd::splat( 0x80 ) ), special ) );
+         if constexpr( RejectC1 ) {
+            const reg c1 = simd::and_( simd::eq( prev1, simd::splat( 0xC2 ) ),
+                                       simd::eq( simd::and_( input, simd::splat( 0xE0 ) ), simd::splat( 0x80 ) ) );
+            error = simd::or_( error, c1 );
+         }
+         prev_incomplete = simd::subs( input, incomplete );
+         prev_input = input;
+      };
+
+      for( ; size_t(end - p) >= 32; p += 32 ) {
+         if( is_ascii_32( p ) ) {
+            error = simd::or_( error, prev_incomplete );
+            continue;
+         }
+         for( size_t i = 0; i < 32; i += width )
+            check_block( simd::load( p + i ) );
+      }
+      for( ; p != end; p += std::min( width, size_t(end - p) ) ) {
+         // zero padding counts as ASCII, so a sequence cut short by the end of the string is invalid
+         alignas(width) unsigned char tail[width] = {};
+         memcpy( tail, p, std::min( width, size_t(end - p) ) );
+         check_block( simd::load( tail ) );
+      }
+      error = simd::or_( error, prev_incomplete );
+      return !simd::any( error );
+   }
+
+#endif
+
+   template<bool RejectC1>
+   bool validate_utf8( const char* data, size_t size ) {
+      auto p = reinterpret_cast<const unsigned char*>( data );
+#if defined(__AVX2__) || defined(__SSE4_1__)
+      return validate_utf8_simd<RejectC1>( p, p + size );
+#else
+      return validate_utf8_scalar<RejectC1>( p, p + size );
+#endif
+   }
+
+} // anonymous namespace
+
     bool is_utf8( const std::string& str )
     {
-       return utf8::is_valid( str.begin(), str.end() );
+       return validate_utf8<false>( str.data(), str.size() );
     }
 
    // tweaked utf8::find_invalid that also considers provided range as invalid
@@ -38,9 +262,7 @@ namespace fc {
 
 
    bool is_valid_utf8( const std::string_view& str ) {
-      const auto invalid_range = std::make_pair<uint32_t, uint32_t>(0x80, 0x9F);
-      auto [itr, v] = find_invalid( str.begin(), str.end(), invalid_range );
-      return itr == str.end();
+      return validate_utf8<true>( str.data(), str.size() );
    }
 
    // escape 0x80-0x9F C1 control characters
@@ -9,6 +9,8 @@
 #include <fc/io/json.hpp>
 #include <fc/utf8.hpp>
 #include <algorithm>
+#include <atomic>
+#include <boost/lexical_cast/try_lexical_convert.hpp>
 
 namespace fc
 {
@@ -21,6 +23,73 @@ void set_variant_type( variant* v, variant::type_id t)
    data[ sizeof(variant) -1 ] = t;
 }
 
+namespace {
+   /**
+    *  Heap storage of string, blob, array and object variants. Copies of a variant share the payload, so copying is
+    *  a reference count increment. The non-const accessors first give the variant a payload of its own and mark it
+    *  as not shareable, because the caller may keep the returned reference and modify through it later; copies of
+    *  such a variant get a deep copy as before.
+    */
+   template<typename T>
+   struct variant_payload {
+      template<typename... Args>
+      explicit variant_payload( Args&&... args ) : value( std::forward<Args>(args)... ) {}
+
+      std::atomic<uint32_t> refs{1};
+      bool                  shareable = true;
+      T                     value;
+   };
+
+   template<typename T>
+   variant_payload<T>* payload_of( const variant* v ) {
+      return *reinterpret_cast<variant_payload<T>* const*>(v);
+   }
+
+   template<typename T>
+   const T& payload_value( const variant* v ) {
+      return payload_of<T>(v)->value;
+   }
+
+   template<typename T, typename... Args>
+   void set_payload( variant* v, variant::type_id t, Args&&... args ) {
+      *reinterpret_cast<variant_payload<T>**>(v) = new variant_payload<T>( std::forward<Args>(args)... );
+      set_variant_type( v, t );
+   }
+
+   /// makes v refer to the payload of o, which must hold a T
+   template<typename T>
+   void share_payload( variant* v, const variant* o ) {
+      variant_payload<T>* p = payload_of<T>(o);
+      if( p->shareable )
+         p->refs.fetch_add( 1, std::memory_order_relaxed );
+      else
+         p = new variant_payload<T>( p->value );
+      *reinterpret_cast<variant_payload<T>**>(v) = p;
+      set_variant_type( v, o->get_type() );
+   }
+
+   template<typename T>
+   void release_payload( variant* v ) {
+      variant_payload<T>* p = payload_of<T>(v);
+      if( p->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+         delete p;
+   }
+
+   /// gives v a payload it does not share with any other variant and returns it for modification
+   template<typename T>
+   T& unshare_payload( variant* v ) {
+      variant_payload<T>* p = payload_of<T>(v);
+      if( p->refs.load( std::memory_order_acquire ) != 1 ) {
+         auto* c = new variant_payload<T>( p->value );
+         release_payload<T>( v );
+         *reinterpret_cast<variant_payload<T>**>(v) = c;
+         p = c;
+      }
+      p->shareable = false;
+      return p->value;
+   }
+}
+
 variant::variant()
 {
    set_variant_type( this, null_type );
@@ -99,14 +168,12 @@ variant::variant( bool val )
 
 variant::variant( char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_payload<string>( this, string_type, str );
 }
 
 variant::variant( const char* str )
 {
-   *reinterpret_cast<string**>(this)  = new string( str );
-   set_variant_type( this, string_type );
+   set_payload<string>( this, string_type, str );
 }
 
 // TODO: do a proper conversion to utf8
@@ -116,8 +183,7 @@ variant::variant( wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_payload<string>( this, string_type, buffer.get(), len );
 }
 
 // TODO: do a proper conversion to utf8
@@ -127,59 +193,48 @@ variant::variant( const wchar_t* str )
    boost::scoped_array<char> buffer(new char[len]);
    for (unsigned i = 0; i < len; ++i)
      buffer[i] = (char)str[i];
-   *reinterpret_cast<string**>(this)  = new string(buffer.get(), len);
-   set_variant_type( this, string_type );
+   set_payload<string>( this, string_type, buffer.get(), len );
 }
 
 variant::variant( fc::string val )
 {
-   *reinterpret_cast<string**>(this)  = new string( fc::move(val) );
-   set_variant_type( this, string_type );
+   set_payload<string>( this, string_type, fc::move(val) );
 }
 variant::variant( blob val )
 {
-   *reinterpret_cast<blob**>(this)  = new blob( fc::move(val) );
-   set_variant_type( this, blob_type );
+   set_payload<blob>( this, blob_type, fc::move(val) );
 }
 
 variant::variant( variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload<variant_object>( this, object_type, fc::move(obj) );
 }
 variant::variant( mutable_variant_object obj)
 {
-   *reinterpret_cast<variant_object**>(this)  = new variant_object(fc::move(obj));
-   set_variant_type(this,  object_type );
+   set_payload<variant_object>( this, object_type, fc::move(obj) );
 }
 
 variant::variant( variants arr )
 {
-   *reinterpret_cast<variants**>(this)  = new variants(fc::move(arr));
-   set_variant_type(this,  array_type );
+   set_payload<variants>( this, array_type, fc::move(arr) );
 }
 
 
-typedef const variant_object* const_variant_object_ptr;
-typedef const variants* const_variants_ptr;
-typedef const blob*   const_blob_ptr;
-typedef const string* const_string_ptr;
-
 void variant::clear()
 {
    switch( get_type() )
    {
      case object_type:
-        delete *reinterpret_cast<variant_object**>(this);
+        release_payload<variant_object>( this );
         break;
      case array_type:
-        delete *reinterpret_cast<variants**>(this);
+        release_payload<variants>( this );
         break;
      case string_type:
-        delete *reinterpret_cast<string**>(this);
+        release_payload<string>( this );
         break;
      case blob_type:
-        delete *reinterpret_cast<blob**>(this);
+        release_payload<blob>( this );
         break;
      default:
         break;
@@ -192,24 +247,16 @@ variant::variant( const variant& v )
    switch( v.get_type() )
    {
        case object_type:
-          *reinterpret_cast<variant_object**>(this)  =
-             new variant_object(**reinterpret_cast<const const_variant_object_ptr*>(&v));
-          set_variant_type( this, object_type );
+          share_payload<variant_object>( this, &v );
           return;
        case array_type:
-          *reinterpret_cast<variants**>(this)  =
-             new variants(**reinterpret_cast<const const_variants_ptr*>(&v));
-          set_variant_type( this,  array_type );
+          share_payload<variants>( this, &v );
           return;
        case string_type:
-          *reinterpret_cast<string**>(this)  =
-             new string(**reinterpret_cast<const const_string_ptr*>(&v) );
-          set_variant_type( this, string_type );
+          share_payload<string>( this, &v );
           return;
        case blob_type:
-          *reinterpret_cast<blob**>(this)  =
-             new blob(**reinterpret_cast<const const_blob_ptr*>(&v) );
-          set_variant_type( this, blob_type );
+          share_payload<blob>( this, &v );
           return;
        default:
           memcpy( this, &v, sizeof(v) );
@@ -241,28 +288,8 @@ variant& variant::operator=( const variant& v )
    if( this == &v )
       return *this;
 
-   clear();
-   switch( v.get_type() )
-   {
-      case object_type:
-         *reinterpret_cast<variant_object**>(this)  =
-            new variant_object((**reinterpret_cast<const const_variant_object_ptr*>(&v)));
-         break;
-      case array_type:
-         *reinterpret_cast<variants**>(this)  =
-            new variants((**reinterpret_cast<const const_variants_ptr*>(&v)));
-         break;
-      case string_type:
-         *reinterpret_cast<string**>(this)  = new string((**reinterpret_cast<const const_string_ptr*>(&v)) );
-         break;
-      case blob_type:
-         *reinterpret_cast<blob**>(this)  = new blob((**reinterpret_cast<const const_blob_ptr*>(&v)) );
-         break;
-      default:
-         memcpy( this, &v, sizeof(v) );
-   }
-   set_variant_type( this, v.get_type() );
-   return *this;
+   // share before releasing the current payload, v may be part of it
+   return *this = variant( v );
 }
 
 void  variant::visit( const visitor& v )const
@@ -285,16 +312,16 @@ void  variant::visit( const visitor& v )const
          v.handle( *reinterpret_cast<const bool*>(this) );
          return;
       case string_type:
-         v.handle( **reinterpret_cast<const const_string_ptr*>(this) );
+         v.handle( payload_value<string>(this) );
          return;
       case array_type:
-         v.handle( **reinterpret_cast<const const_variants_ptr*>(this) );
+         v.handle( payload_value<variants>(this) );
          return;
       case object_type:
-         v.handle( **reinterpret_cast<const const_variant_object_ptr*>(this) );
+         v.handle( payload_value<variant_object>(this) );
          return;
       case blob_type:
-         v.handle( **reinterpret_cast<const const_blob_ptr*>(this) );
+         v.handle( payload_value<blob>(this) );
          return;
       default:
          FC_THROW_EXCEPTION( assert_exception, "Invalid Type / Corrupted Memory" );
@@ -379,7 +406,7 @@ int64_t variant::as_int64()const
    switch( get_type() )
    {
       case string_type:
-          return to_int64(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_int64(payload_value<string>(this));
       case double_type:
           return int64_t(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -400,7 +427,7 @@ uint64_t variant::as_uint64()const
    switch( get_type() )
    {
       case string_type:
-          return to_uint64(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_uint64(payload_value<string>(this));
       case double_type:
           return static_cast<uint64_t>(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -422,7 +449,7 @@ double  variant::as_double()const
    switch( get_type() )
    {
       case string_type:
-          return to_double(**reinterpret_cast<const const_string_ptr*>(this));
+          return to_double(payload_value<string>(this));
       case double_type:
           return *reinterpret_cast<const double*>(this);
       case int64_type:
@@ -444,7 +471,7 @@ bool  variant::as_bool()const
    {
       case string_type:
       {
-          const string& s = **reinterpret_cast<const const_string_ptr*>(this);
+          const string& s = payload_value<string>(this);
           if( s == "true" )
              return true;
           if( s == "false" )
@@ -471,7 +498,7 @@ string    variant::as_string()const
    switch( get_type() )
    {
       case string_type:
-          return **reinterpret_cast<const const_string_ptr*>(this);
+          return payload_value<string>(this);
       case double_type:
           return to_string(*reinterpret_cast<const double*>(this));
       case int64_type:
@@ -496,21 +523,21 @@ string    variant::as_string()const
 variants&         variant::get_array()
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<variants**>(this);
+     return unshare_payload<variants>(this);
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 blob&         variant::get_blob()
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<blob**>(this);
+     return unshare_payload<blob>(this);
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
 const blob&         variant::get_blob()const
 {
   if( get_type() == blob_type )
-     return **reinterpret_cast<const const_blob_ptr*>(this);
+     return payload_value<blob>(this);
 
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Blob", ("type",get_type()) );
 }
@@ -545,7 +572,7 @@ blob variant::as_blob()const
 const variants&       variant::get_array()const
 {
   if( get_type() == array_type )
-     return **reinterpret_cast<const const_variants_ptr*>(this);
+     return payload_value<variants>(this);
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Array", ("type",get_type()) );
 }
 
@@ -554,7 +581,7 @@ const variants&       variant::get_array()const
 variant_object&        variant::get_object()
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<variant_object**>(this);
+     return unshare_payload<variant_object>(this);
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from ${type} to Object", ("type",get_type()) );
 }
 
@@ -606,7 +633,7 @@ size_t variant::estimated_size()const
 const string&        variant::get_string()const
 {
   if( get_type() == string_type )
-     return **reinterpret_cast<const const_string_ptr*>(this);
+     return payload_value<string>(this);
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to string", ("type",get_type()) );
 }
 
@@ -614,7 +641,7 @@ const string&        variant::get_string()const
 const variant_object&  variant::get_object()const
 {
   if( get_type() == object_type )
-     return **reinterpret_cast<const const_variant_object_ptr*>(this);
+     return payload_value<variant_object>(this);
   FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast from type '${type}' to Object", ("type",get_type()) );
 }
 
@@ -716,6 +743,158 @@ void from_variant( const variant& var,  float& vo )
    vo = static_cast<float>(var.as_double());
 }
 
+namespace {
+   bool checked_failure( from_variant_error& err, from_variant_error::code_type code )
+   {
+      err.code = code;
+      return false;
+   }
+
+   /// same conversions as as_int64() / as_uint64(), without throwing
+   template<typename T>
+   bool try_as_integer( const variant& v, T& o, from_variant_error& err )
+   {
+      if( v.is_string() ) {
+         const string& str = v.get_string();
+         if( boost::conversion::try_lexical_convert( str.c_str(), str.size(), o ) )
+            return true;
+         return checked_failure( err, from_variant_error::invalid_value );
+      }
+      if( !v.is_numeric() && !v.is_null() )
+         return checked_failure( err, from_variant_error::type_mismatch );
+      if constexpr( std::is_signed_v<T> )
+         o = v.as_int64();
+      else
+         o = v.as_uint64();
+      return true;
+   }
+
+   /// narrowing as in from_variant() of the smaller integer types
+   template<typename T>
+   bool try_as_narrow_integer( const variant& v, T& o, from_variant_error& err )
+   {
+      std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t> wide;
+      if( !try_as_integer( v, wide, err ) )
+         return false;
+      o = static_cast<T>( wide );
+      return true;
+   }
+}
+
+bool try_from_variant( const variant& v, int64_t& o, from_variant_error& err )  { return try_as_integer( v, o, err ); }
+bool try_from_variant( const variant& v, uint64_t& o, from_variant_error& err ) { return try_as_integer( v, o, err ); }
+bool try_from_variant( const variant& v, int32_t& o, from_variant_error& err )  { return try_as_narrow_integer( v, o, err ); }
+bool try_from_variant( const variant& v, uint32_t& o, from_variant_error& err ) { return try_as_narrow_integer( v, o, err ); }
+bool try_from_variant( const variant& v, int16_t& o, from_variant_error& err )  { return try_as_narrow_integer( v, o, err ); }
+bool try_from_variant( const variant& v, uint16_t& o, from_variant_error& err ) { return try_as_narrow_integer( v, o, err ); }
+bool try_from_variant( const variant& v, int8_t& o, from_variant_error& err )   { return try_as_narrow_integer( v, o, err ); }
+bool try_from_variant( const variant& v, uint8_t& o, from_variant_error& err )  { return try_as_narrow_integer( v, o, err ); }
+
+bool try_from_variant( const variant& v, bool& o, from_variant_error& err )
+{
+   if( v.is_string() ) {
+      const string& str = v.get_string();
+      if( str == "true" )
+         o = true;
+      else if( str == "false" )
+         o = false;
+      else
+         return checked_failure( err, from_variant_error::type_mismatch );
+      return true;
+   }
+   if( !v.is_numeric() && !v.is_null() )
+      return checked_failure( err, from_variant_error::type_mismatch );
+   o = v.as_bool();
+   return true;
+}
+
+bool try_from_variant( const variant& v, double& o, from_variant_error& err )
+{
+   if( v.is_string() ) {
+      const string& str = v.get_string();
+      if( boost::conversion::try_lexical_convert( str.c_str(), str.size(), o ) )
+         return true;
+      return checked_failure( err, from_variant_error::invalid_value );
+   }
+   if( !v.is_numeric() && !v.is_null() )
+      return checked_failure( err, from_variant_error::type_mismatch );
+   o = v.as_double();
+   return true;
+}
+
+bool try_from_variant( const variant& v, float& o, from_variant_error& err )
+{
+   double d;
+   if( !try_from_variant( v, d, err ) )
+      return false;
+   o = static_cast<float>( d );
+   return true;
+}
+
+bool try_from_variant( const variant& v, std::string& o, from_variant_error& err )
+{
+   if( v.is_string() )
+      o = v.get_string();
+   else if( v.is_array() || v.is_object() )
+      return checked_failure( err, from_variant_error::type_mismatch );
+   else
+      o = v.as_string();
+   return true;
+}
+
+bool try_from_variant( const variant& v, variant& o, from_variant_error& err )
+{
+   o = v;
+   return true;
+}
+
+bool try_from_variant( const variant& v, variants& o, from_variant_error& err )
+{
+   if( !v.is_array() )
+      return checked_failure( err, from_variant_error::type_mismatch );
+   o = v.get_array();
+   return true;
+}
+
+bool try_from_variant( const variant& v, std::vector<char>& o, from_variant_error& err )
+{
+   // hex string, not an array
+   if( !v.is_string() )
+      return checked_failure( err, from_variant_error::type_mismatch );
+   try {
+      from_variant( v, o );
+   } catch( ... ) {
+      err.nested = std::current_exception();
+      return checked_failure( err, from_variant_error::conversion_failed );
+   }
+   return true;
+}
+
+void from_variant_error::rethrow( const char* type_name )const
+{
+   std::string where = type_name;
+   if( !path.empty() )
+      where += ( path[0] == '[' ? "" : "." ) + path;
+   switch( code ) {
+      case type_mismatch:
+         FC_THROW_EXCEPTION( bad_cast_exception, "Invalid cast for ${where}", ("where", where) );
+      case invalid_value:
+         FC_THROW_EXCEPTION( parse_error_exception, "Couldn't parse ${where}", ("where", where) );
+      case too_large:
+         // what the throwing container conversions throw
+         throw std::range_error( "too large" );
+      case conversion_failed:
+         try {
+            std::rethrow_exception( nested );
+         } catch( fc::exception& e ) {
+            e.append_log( FC_LOG_MESSAGE( warn, "error converting ${where}", ("where", where) ) );
+            throw;
+         }
+      default:
+         FC_THROW_EXCEPTION( assert_exception, "No conversion error for ${where}", ("where", where) );
+   }
+}
+
 void to_variant( const std::string& s, variant& v )
 {
    v = variant( fc::string(s) );
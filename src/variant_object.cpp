@@ -1,5 +1,6 @@
 #include <fc/variant_object.hpp>
 #include <fc/exception/exception.hpp>
+#include <string_view>
 
 
 namespace fc
@@ -9,13 +10,15 @@ namespace fc
 
    variant_object::entry::entry() {}
    variant_object::entry::entry( string k, variant v ) : _key(fc::move(k)),_value(fc::move(v)) {}
-   variant_object::entry::entry( entry&& e ) : _key(fc::move(e._key)),_value(fc::move(e._value)) {}
-   variant_object::entry::entry( const entry& e ) : _key(e._key),_value(e._value) {}
+   variant_object::entry::entry( const string* k, variant v ) : _static_key(k),_value(fc::move(v)) {}
+   variant_object::entry::entry( entry&& e ) : _key(fc::move(e._key)),_static_key(e._static_key),_value(fc::move(e._value)) {}
+   variant_object::entry::entry( const entry& e ) : _key(e._key),_static_key(e._static_key),_value(e._value) {}
    variant_object::entry& variant_object::entry::operator=( const variant_object::entry& e )
    {
       if( this != &e )
       {
          _key = e._key;
+         _static_key = e._static_key;
          _value = e._value;
       }
       return *this;
@@ -23,15 +26,11 @@ namespace fc
    variant_object::entry& variant_object::entry::operator=( variant_object::entry&& e )
    {
       fc_swap( _key, e._key );
+      std::swap( _static_key, e._static_key );
       fc_swap( _value, e._value );
       return *this;
    }
 
-   const string&        variant_object::entry::key()const
-   {
-      return _key;
-   }
-
    const variant& variant_object::entry::value()const
    {
       return _value;
@@ -62,7 +61,15 @@ namespace fc
 
    variant_object::iterator variant_object::find( const string& key )const
    {
-      return find( key.c_str() );
+      for( auto itr = begin(); itr != end(); ++itr )
+      {
+         // keys of reflected members usually refer to the same string, see fc::reflected_member_key()
+         if( &itr->key() == &key || itr->key() == key )
+         {
+            return itr;
+         }
+      }
+      return end();
    }
 
    variant_object::iterator variant_object::find( const char* key )const
@@ -127,6 +134,7 @@ namespace fc
    variant_object::variant_object( mutable_variant_object&& obj )
    : _key_value(fc::move(obj._key_value))
    {
+      obj._index.reset();
       FC_ASSERT( _key_value != nullptr );
    }
 
@@ -153,12 +161,13 @@ namespace fc
    {
       _key_value = fc::move(obj._key_value);
       obj._key_value.reset( new std::vector<entry>() );
+      obj._index.reset();
       return *this;
    }
 
    variant_object& variant_object::operator=( const mutable_variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      std::vector<entry>( *obj._key_value ).swap( *_key_value );
       return *this;
    }
 
@@ -214,14 +223,7 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )const
    {
-      for( auto itr = begin(); itr != end(); ++itr )
-      {
-         if( itr->key() == key )
-         {
-            return itr;
-         }
-      }
-      return end();
+      return begin() + find_index( key );
    }
 
    mutable_variant_object::iterator mutable_variant_object::find( const string& key )
@@ -231,14 +233,54 @@ namespace fc
 
    mutable_variant_object::iterator mutable_variant_object::find( const char* key )
    {
-      for( auto itr = begin(); itr != end(); ++itr )
+      return begin() + find_index( key );
+   }
+
+   size_t mutable_variant_object::find_index( const char* key )const
+   {
+      const std::vector<entry>& kv = *_key_value;
+      if( !_index )
       {
-         if( itr->key() == key )
+         for( size_t i = 0; i < kv.size(); ++i )
          {
-            return itr;
+            if( kv[i].key() == key )
+               return i;
          }
+         return kv.size();
       }
-      return end();
+
+      const std::string_view k( key );
+      size_t found = kv.size();
+      auto range = _index->equal_range( std::hash<std::string_view>()( k ) );
+      for( auto itr = range.first; itr != range.second; ++itr )
+      {
+         // keys appended with operator() may repeat, the first one wins as with a linear search
+         if( itr->second < found && kv[itr->second].key() == k )
+            found = itr->second;
+      }
+      return found;
+   }
+
+   void mutable_variant_object::push_back( entry e )
+   {
+      if( _index )
+         _index->emplace( std::hash<std::string_view>()( e.key() ), _key_value->size() );
+      _key_value->emplace_back( fc::move(e) );
+      if( !_index && _key_value->size() >= index_threshold )
+         rebuild_index();
+   }
+
+   void mutable_variant_object::rebuild_index()
+   {
+      const std::vector<entry>& kv = *_key_value;
+      if( kv.size() < index_threshold )
+      {
+         _index.reset();
+         return;
+      }
+      _index.reset( new std::unordered_multimap<size_t, size_t>( kv.size() ) );
+      for( size_t i = 0; i < kv.size(); ++i )
+         _index->emplace( std::hash<std::string_view>()( kv[i].key() ), i );
    }
 
    const variant& mutable_variant_object::operator[]( const string& key )const
@@ -261,7 +303,7 @@ namespace fc
    {
       auto itr = find( key );
       if( itr != end() ) return itr->value();
-      _key_value->emplace_back(entry(key, variant()));
+      push_back( entry( key, variant() ) );
       return _key_value->back().value();
    }
 
@@ -278,27 +320,30 @@ namespace fc
    mutable_variant_object::mutable_variant_object( string key, variant val )
       : _key_value(new std::vector<entry>())
    {
-       _key_value->push_back(entry(fc::move(key), fc::move(val)));
+       _key_value->emplace_back( fc::move(key), fc::move(val) );
    }
 
    mutable_variant_object::mutable_variant_object( const variant_object& obj )
       : _key_value( new std::vector<entry>(*obj._key_value) )
    {
+      rebuild_index();
    }
 
    mutable_variant_object::mutable_variant_object( const mutable_variant_object& obj )
-      : _key_value( new std::vector<entry>(*obj._key_value) )
+      : _key_value( new std::vector<entry>(*obj._key_value) ),
+        _index( obj._index ? new std::unordered_multimap<size_t, size_t>( *obj._index ) : nullptr )
    {
    }
 
    mutable_variant_object::mutable_variant_object( mutable_variant_object&& obj )
-      : _key_value(fc::move(obj._key_value))
+      : _key_value(fc::move(obj._key_value)), _index(fc::move(obj._index))
    {
    }
 
    mutable_variant_object& mutable_variant_object::operator=( const variant_object& obj )
    {
-      *_key_value = *obj._key_value;
+      std::vector<entry>( *obj._key_value ).swap( *_key_value );
+      rebuild_index();
       return *this;
    }
 
@@ -307,6 +352,7 @@ namespace fc
       if (this != &obj)
       {
          _key_value = fc::move(obj._key_value);
+         _index = fc::move(obj._index);
       }
       return *this;
    }
@@ -315,7 +361,8 @@ namespace fc
    {
       if (this != &obj)
       {
-         *_key_value = *obj._key_value;
+         std::vector<entry>( *obj._key_value ).swap( *_key_value );
+         _index.reset( obj._index ? new std::unordered_multimap<size_t, size_t>( *obj._index ) : nullptr );
       }
       return *this;
    }
@@ -331,7 +378,11 @@ namespace fc
       {
          if( itr->key() == key )
          {
-            _key_value->erase(itr);
+            // entries are only assignable here, so shift them down rather than through std::vector::erase
+            for( auto next = itr + 1; next != end(); ++itr, ++next )
+               *itr = fc::move( *next );
+            _key_value->pop_back();
+            rebuild_index();
             return;
          }
       }
@@ -347,7 +398,7 @@ namespace fc
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         push_back( entry( fc::move(key), fc::move(var) ) );
       }
       return *this;
    }
@@ -361,7 +412,7 @@ namespace fc
       }
       else
       {
-         _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+         push_back( entry( fc::move(key), fc::move(var) ) );
       }
       return std::move(*this);
    }
@@ -371,16 +422,28 @@ namespace fc
     */
    mutable_variant_object& mutable_variant_object::operator()( string key, variant var ) &
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      push_back( entry( fc::move(key), fc::move(var) ) );
       return *this;
    }
 
    mutable_variant_object mutable_variant_object::operator()( string key, variant var ) &&
    {
-      _key_value->push_back( entry( fc::move(key), fc::move(var) ) );
+      push_back( entry( fc::move(key), fc::move(var) ) );
       return std::move(*this);
    }
 
+   mutable_variant_object& mutable_variant_object::append_unique( string key, variant var )
+   {
+      push_back( entry( fc::move(key), fc::move(var) ) );
+      return *this;
+   }
+
+   mutable_variant_object& mutable_variant_object::append_unique( const string* key, variant var )
+   {
+      push_back( entry( key, fc::move(var) ) );
+      return *this;
+   }
+
    mutable_variant_object& mutable_variant_object::operator()( const variant_object& vo ) &
    {
       for( const variant_object::entry& e : vo )
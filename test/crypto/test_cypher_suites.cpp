@@ -43,6 +43,38 @@ BOOST_AUTO_TEST_CASE(test_k1_recovery) try {
    BOOST_CHECK_EQUAL(recovered_pub.to_string(), pub.to_string());
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(test_k1_prepared_public_key) try {
+   auto key = ecc::private_key::generate();
+   ecc::prepared_public_key prepared(key.get_public_key());
+   BOOST_CHECK(prepared.get_public_key() == key.get_public_key());
+
+   for( int i = 0; i < 16; ++i ) {
+      auto digest = sha256::hash(std::to_string(i));
+      auto sig = key.sign_compact(digest);
+      BOOST_CHECK(prepared.verify_ignoring_recovery_id(digest, sig));
+      BOOST_CHECK(ecc::public_key(sig, digest) == prepared.get_public_key());
+      BOOST_CHECK(!prepared.verify_ignoring_recovery_id(sha256::hash(std::string("other")), sig));
+   }
+
+   auto other = ecc::private_key::generate();
+   auto digest = sha256::hash(std::string("sup"));
+   BOOST_CHECK(!prepared.verify_ignoring_recovery_id(digest, other.sign_compact(digest)));
+   auto sig = key.sign_compact(digest);
+
+   // the recovery id is not checked, unlike recovering and comparing
+   auto flipped = sig;
+   flipped.data[0] = 27 + 4 + (((sig.data[0] - 27) & 3) ^ 1);
+   BOOST_CHECK(prepared.verify_ignoring_recovery_id(digest, flipped));
+   BOOST_CHECK(!(ecc::public_key(flipped, digest) == prepared.get_public_key()));
+
+   sig.data[0] = 26;
+   BOOST_CHECK(!prepared.verify_ignoring_recovery_id(digest, sig));
+   BOOST_CHECK(!ecc::prepared_public_key().verify_ignoring_recovery_id(digest, key.sign_compact(digest)));
+
+   BOOST_CHECK(other.get_shared_secret(prepared) == other.get_shared_secret(key.get_public_key()));
+   BOOST_CHECK(other.get_shared_secret(prepared) == key.get_shared_secret(other.get_public_key()));
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(test_r1_recovery) try {
    auto payload = "Test Cases";
    auto digest = sha256::hash(payload, const_strlen(payload));
@@ -56,6 +88,44 @@ BOOST_AUTO_TEST_CASE(test_r1_recovery) try {
    BOOST_CHECK_EQUAL(recovered_pub.to_string(), pub.to_string());
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(test_r1_recovery_matches_openssl) try {
+   std::vector<std::pair<r1::compact_signature, sha256>> sigs;
+   std::vector<r1::public_key_data> expected;
+   for( int i = 0; i < 32; ++i ) {
+      auto digest = sha256::hash(std::to_string(i));
+      auto key = r1::private_key::generate();
+      sigs.emplace_back(key.sign_compact(digest), digest);
+      expected.emplace_back(key.get_public_key().serialize());
+   }
+
+   for( size_t i = 0; i < sigs.size(); ++i ) {
+      BOOST_CHECK(r1::public_key(sigs[i].first, sigs[i].second).serialize() == expected[i]);
+      BOOST_CHECK(r1::recover_public_key_data(sigs[i].first, sigs[i].second) == expected[i]);
+   }
+   BOOST_CHECK(r1::recover_public_key_data_batch(sigs) == expected);
+
+   // a different digest recovers a different key on both paths
+   auto other = sha256::hash(std::string("other"));
+   BOOST_CHECK(r1::recover_public_key_data(sigs[0].first, other) == r1::public_key(sigs[0].first, other).serialize());
+   BOOST_CHECK(r1::recover_public_key_data(sigs[0].first, other) != expected[0]);
+
+   // both paths reject a bad recovery id and a zero signature
+   auto bad = sigs[0].first;
+   bad.data[0] = 26;
+   BOOST_CHECK_THROW(r1::recover_public_key_data(bad, sigs[0].second), fc::exception);
+   BOOST_CHECK_THROW(r1::public_key(bad, sigs[0].second), fc::exception);
+   r1::compact_signature zero;
+   memset(zero.data, 0, sizeof(zero.data));
+   zero.data[0] = 31;
+   BOOST_CHECK_THROW(r1::recover_public_key_data(zero, sigs[0].second), fc::exception);
+   BOOST_CHECK_THROW(r1::public_key(zero, sigs[0].second), fc::exception);
+
+   // s == 0 with a valid r is accepted by the EC_KEY recovery, so the cached path accepts it too
+   auto zero_s = sigs[0].first;
+   memset(zero_s.data + 33, 0, 32);
+   BOOST_CHECK(r1::recover_public_key_data(zero_s, sigs[0].second) == r1::public_key(zero_s, sigs[0].second).serialize());
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(test_k1_recyle) try {
    auto key = private_key::generate<ecc::private_key_shim>();
    auto pub = key.get_public_key();
@@ -119,6 +119,156 @@ BOOST_AUTO_TEST_CASE(modexp) try {
 
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(modexp_context_matches_modexp) try {
+
+    std::mt19937 r(0x55667788);
+
+    auto generate_random_bytes = [](std::mt19937& rand_eng, unsigned int num_bytes) {
+        std::vector<char> result(num_bytes);
+        for (auto& c : result) {
+            c = rand_eng() & 0xFF;
+        }
+        return result;
+    };
+
+    for (unsigned int n : {1u, 7u, 32u, 64u, 128u, 256u}) {
+        auto modulus = generate_random_bytes(r, n);
+        modulus.back() |= 1; // odd, so the constant-time path is exercised
+
+        modexp_context ctx(modulus);
+        modexp_context ct_ctx(modulus, true);
+
+        for (unsigned int exponent_num_bytes : {0u, 1u, 32u, 33u, 100u}) {
+            auto exponent = generate_random_bytes(r, exponent_num_bytes);
+
+            std::vector<bytes> bases;
+            for (unsigned int i = 0; i < 4; ++i) {
+                bases.push_back(generate_random_bytes(r, n));
+            }
+            bases.push_back(bytes{});
+
+            unsigned int yields = 0;
+            yield_function_t yield = [&yields]() { ++yields; };
+
+            for (const auto& base : bases) {
+                auto expected = fc::modexp(base, exponent, modulus);
+                BOOST_CHECK_EQUAL(ctx.modexp(base, exponent), expected);
+                BOOST_CHECK_EQUAL(ct_ctx.modexp(base, exponent), expected);
+                BOOST_CHECK_EQUAL(ctx.modexp(base, exponent, yield), expected);
+                BOOST_CHECK_EQUAL(ct_ctx.modexp(base, exponent, yield), expected);
+            }
+
+            // exponents longer than one chunk yield between chunks
+            if (exponent_num_bytes * 8 > modexp_context::yield_chunk_bits) {
+                BOOST_CHECK_GT(yields, 0u);
+            } else {
+                BOOST_CHECK_EQUAL(yields, 0u);
+            }
+
+            auto batch = ctx.modexp_batch(bases, exponent, yield);
+            BOOST_REQUIRE(std::holds_alternative<std::vector<bytes>>(batch));
+            const auto& results = std::get<std::vector<bytes>>(batch);
+            BOOST_REQUIRE_EQUAL(results.size(), bases.size());
+            for (size_t i = 0; i < bases.size(); ++i) {
+                BOOST_CHECK(results[i] == std::get<bytes>(fc::modexp(bases[i], exponent, modulus)));
+            }
+        }
+    }
+
+    // exponents with all-zero chunks, including exact powers of two at chunk boundaries
+    {
+        auto modulus = generate_random_bytes(r, 64);
+        modulus.back() |= 1;
+        modexp_context ct_ctx(modulus, true);
+        yield_function_t yield = []() {};
+
+        for (unsigned int exponent_num_bytes : {33u, 64u, 65u, 97u}) {
+            bytes exponent(exponent_num_bytes, '\0');
+            exponent.front() = 1;
+            for (unsigned int low : {0u, 1u, 0xffu}) {
+                exponent.back() = low;
+                auto base = generate_random_bytes(r, 64);
+                BOOST_CHECK_EQUAL(ct_ctx.modexp(base, exponent, yield), fc::modexp(base, exponent, modulus));
+            }
+        }
+    }
+
+    // yield may abort a long exponentiation by throwing
+    {
+        auto modulus  = generate_random_bytes(r, 64);
+        auto exponent = generate_random_bytes(r, 128);
+        modexp_context ctx(modulus);
+        yield_function_t deadline = []() { FC_THROW_EXCEPTION(fc::timeout_exception, "deadline exceeded"); };
+        BOOST_CHECK_THROW(ctx.modexp(generate_random_bytes(r, 64), exponent, deadline), fc::timeout_exception);
+        // context remains usable afterwards
+        auto base = generate_random_bytes(r, 64);
+        BOOST_CHECK_EQUAL(ctx.modexp(base, exponent), fc::modexp(base, exponent, modulus));
+    }
+
+    // degenerate moduli behave as in fc::modexp
+    {
+        using modexp_result = std::variant<fc::modular_arithmetic_error, bytes>;
+
+        modexp_context empty(bytes{});
+        BOOST_CHECK_EQUAL(empty.modexp(to_bytes("01"), to_bytes("01")), fc::modexp(to_bytes("01"), to_bytes("01"), bytes{}));
+        BOOST_CHECK(std::holds_alternative<modular_arithmetic_error>(empty.modexp_batch({to_bytes("01")}, to_bytes("01"))));
+
+        modexp_context zero(to_bytes("0000"), true);
+        BOOST_CHECK_EQUAL(zero.modexp(to_bytes("01"), to_bytes("01")), modexp_result(to_bytes("0000")));
+
+        modexp_context even(to_bytes("10"), true);
+        BOOST_CHECK_EQUAL(even.modexp(to_bytes("03"), to_bytes("03")), modexp_result(to_bytes("0b")));
+    }
+
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(modexp_context_benchmarking) try {
+
+    std::mt19937 r(0x99aabbcc);
+
+    auto generate_random_bytes = [](std::mt19937& rand_eng, unsigned int num_bytes) {
+        std::vector<char> result(num_bytes);
+        for (auto& c : result) {
+            c = rand_eng() & 0xFF;
+        }
+        return result;
+    };
+
+    static constexpr unsigned int num_bases = 8; // 1000
+
+    // RSA-style verification: small public exponent, many bases, one modulus
+    for (unsigned int n = 32; n <= 512; n *= 2) {
+        auto modulus = generate_random_bytes(r, n);
+        modulus.back() |= 1;
+        auto exponent = to_bytes("010001");
+
+        std::vector<bytes> bases;
+        for (unsigned int i = 0; i < num_bases; ++i) {
+            bases.push_back(generate_random_bytes(r, n));
+        }
+
+        auto start_time = std::chrono::steady_clock::now();
+        for (const auto& base : bases) {
+            auto res = fc::modexp(base, exponent, modulus);
+        }
+        auto mid_time = std::chrono::steady_clock::now();
+
+        modexp_context ctx(modulus);
+        auto batch = ctx.modexp_batch(bases, exponent);
+
+        auto end_time = std::chrono::steady_clock::now();
+
+        BOOST_REQUIRE(std::holds_alternative<std::vector<bytes>>(batch));
+
+        int64_t single_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mid_time - start_time).count();
+        int64_t batch_ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - mid_time).count();
+
+        ilog("${bit_width}-bit modulus, 17-bit exponent, ${count} bases: modexp ${single} ns; modexp_context::modexp_batch ${batch} ns",
+             ("bit_width", n * 8)("count", num_bases)("single", single_ns / num_bases)("batch", batch_ns / num_bases));
+    }
+
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(modexp_benchmarking) try {
 
     std::mt19937 r(0x11223344);
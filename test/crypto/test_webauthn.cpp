@@ -56,6 +56,32 @@ BOOST_AUTO_TEST_CASE(good) try {
    BOOST_CHECK_EQUAL(wa_pub, make_webauthn_sig(priv, auth_data, json).recover(d, true));
 } FC_LOG_AND_RETHROW();
 
+//Good signatures recovered as a batch, interleaved with a different digest
+BOOST_AUTO_TEST_CASE(good_batch) try {
+   webauthn::public_key wa_pub(pub.serialize(), webauthn::public_key::user_presence_t::USER_PRESENCE_NONE, "fctesting.invalid");
+   std::vector<uint8_t> auth_data(37);
+   memcpy(auth_data.data(), origin_hash.data(), sizeof(origin_hash));
+
+   std::vector<std::pair<webauthn::signature, fc::sha256>> sigs;
+   for(unsigned i = 0; i < 8; ++i) {
+      fc::sha256 digest = fc::sha256::hash(std::to_string(i));
+      std::string json = "{\"origin\":\"https://fctesting.invalid\",\"type\":\"webauthn.get\",\"challenge\":\"" + fc::base64url_encode(digest.data(), digest.data_size()) + "\"}";
+      sigs.emplace_back(make_webauthn_sig(priv, auth_data, json), digest);
+   }
+
+   std::vector<webauthn::public_key> keys = webauthn::recover_public_key_batch(sigs);
+   BOOST_REQUIRE_EQUAL(keys.size(), sigs.size());
+   for(unsigned i = 0; i < keys.size(); ++i) {
+      BOOST_CHECK_EQUAL(wa_pub, keys[i]);
+      BOOST_CHECK_EQUAL(keys[i], sigs[i].first.recover(sigs[i].second, true));
+   }
+
+   sigs[3].second = d;
+   BOOST_CHECK_EXCEPTION(webauthn::recover_public_key_batch(sigs), fc::assert_exception, [](const fc::assert_exception& e) {
+      return e.to_detail_string().find("Wrong webauthn challenge") != std::string::npos;
+   });
+} FC_LOG_AND_RETHROW();
+
 //A valid signature but shouldn't match public key due to presence difference
 BOOST_AUTO_TEST_CASE(mismatch_presence) try {
    webauthn::public_key wa_pub(pub.serialize(), webauthn::public_key::user_presence_t::USER_PRESENCE_PRESENT, "fctesting.invalid");
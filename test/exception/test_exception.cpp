@@ -0,0 +1,102 @@
+#define BOOST_TEST_MODULE exception
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/variant_object.hpp>
+#include <fc/time.hpp>
+
+using namespace fc;
+
+namespace {
+   void throw_at_depth( size_t depth, uint64_t value ) {
+      try {
+         if( depth == 0 )
+            FC_ASSERT( value == 0, "unexpected value ${v}", ("v", value) );
+         else
+            throw_at_depth( depth - 1, value );
+      } FC_RETHROW_EXCEPTIONS( warn, "depth ${d}", ("d", depth) )
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(exception_test_suite)
+
+BOOST_AUTO_TEST_CASE(log_context_of_call_site)
+{
+   const uint64_t line = __LINE__ + 1;
+   fc::log_message m = FC_LOG_MESSAGE( warn, "value ${v}", ("v", 42) );
+   const fc::log_context ctx = m.get_context();
+   BOOST_CHECK_EQUAL( ctx.get_file(), "test_exception.cpp" );
+   BOOST_CHECK_EQUAL( ctx.get_line_number(), line );
+   BOOST_CHECK_EQUAL( ctx.get_method(), "test_method" );
+   BOOST_CHECK( ctx.get_log_level() == log_level::warn );
+   BOOST_CHECK_EQUAL( m.get_message(), "value 42" );
+
+   // a context restored from its variant form reports the same
+   const fc::log_context restored( ctx.to_variant() );
+   BOOST_CHECK_EQUAL( restored.get_file(), ctx.get_file() );
+   BOOST_CHECK_EQUAL( restored.get_method(), ctx.get_method() );
+   BOOST_CHECK_EQUAL( restored.get_line_number(), line );
+   BOOST_CHECK_EQUAL( restored.get_thread_name(), ctx.get_thread_name() );
+}
+
+BOOST_AUTO_TEST_CASE(log_context_copies_runtime_strings)
+{
+   std::unique_ptr<fc::log_context> ctx;
+   {
+      std::string file = "/some/dir/runtime_file.cpp";
+      std::string method = "runtime_method";
+      ctx = std::make_unique<fc::log_context>( log_level::info, file.c_str(), 7, method.c_str() );
+      file.assign( file.size(), 'x' );
+      method.assign( method.size(), 'x' );
+   }
+   BOOST_CHECK_EQUAL( ctx->get_file(), "runtime_file.cpp" );
+   BOOST_CHECK_EQUAL( ctx->get_method(), "runtime_method" );
+   BOOST_CHECK_EQUAL( ctx->get_line_number(), 7u );
+}
+
+BOOST_AUTO_TEST_CASE(rethrow_appends_log)
+{
+   try {
+      throw_at_depth( 4, 7 );
+      BOOST_FAIL( "expected exception" );
+   } catch( const fc::assert_exception& e ) {
+      BOOST_CHECK_EQUAL( e.name(), "assert_exception" );
+      BOOST_CHECK_EQUAL( e.what(), "Assert Exception" );
+      BOOST_CHECK_EQUAL( e.code(), assert_exception_code );
+      BOOST_REQUIRE_EQUAL( e.get_log().size(), 6u );
+      BOOST_CHECK_EQUAL( e.get_log()[0].get_message(), "value == 0: unexpected value 7" );
+      BOOST_CHECK_EQUAL( e.get_log()[5].get_message(), "depth 4" );
+
+      const fc::assert_exception copy( e );
+      BOOST_CHECK_EQUAL( copy.name(), "assert_exception" );
+      BOOST_CHECK_EQUAL( copy.get_log().size(), 6u );
+
+      variant v;
+      fc::to_variant( e, v );
+      fc::exception restored;
+      fc::from_variant( v, restored );
+      BOOST_CHECK_EQUAL( restored.name(), "assert_exception" );
+      BOOST_CHECK_EQUAL( restored.what(), "Assert Exception" );
+      BOOST_CHECK_EQUAL( restored.to_detail_string(), e.to_detail_string() );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(throw_catch_benchmark)
+{
+   const size_t loops = 100; // 100000
+   size_t caught = 0;
+   auto start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i ) {
+      try {
+         throw_at_depth( 4, i + 1 );
+      } catch( const fc::exception& e ) {
+         caught += e.get_log().size();
+      }
+   }
+   auto elapsed = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( caught, 6 * loops );
+   ilog( "${n} FC_ASSERT throws caught through 5 levels of FC_RETHROW_EXCEPTIONS: ${t} us, ${p} ns each",
+         ("n", loops)("t", elapsed.count())("p", elapsed.count() * 1000 / loops) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
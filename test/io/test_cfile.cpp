@@ -2,6 +2,11 @@
 #include <boost/test/included/unit_test.hpp>
 
 #include <fc/io/cfile.hpp>
+#include <fc/io/fd_file.hpp>
+#include <fc/io/raw.hpp>
+
+#include <chrono>
+#include <random>
 
 using namespace fc;
 
@@ -158,3 +163,225 @@ BOOST_AUTO_TEST_SUITE(cfile_test_suite)
    }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(fd_file_test_suite)
+   BOOST_AUTO_TEST_CASE(test_simple)
+   {
+      fc::temp_directory tempdir;
+
+      // exercise unbuffered, tiny and default buffers
+      for( size_t buf_size : { size_t(0), size_t(2), fd_file::default_write_buffer_size } ) {
+         fd_file t;
+         t.set_file_path( tempdir.path() / "test" );
+         t.set_write_buffer_size( buf_size );
+         t.set_read_buffer_size( buf_size );
+         t.open( "wb+" );
+         BOOST_CHECK( t.is_open() );
+
+         t.write( "abc", 3 );
+         BOOST_CHECK_EQUAL( t.tellp(), 3u );
+         std::vector<char> v(3);
+         t.seek( 0 );
+         t.read( &v[0], 3 );
+         BOOST_CHECK_EQUAL( std::string( v.data(), 3 ), "abc" );
+
+         t.seek_end( -2 );
+         BOOST_CHECK_EQUAL( t.tellp(), 1u );
+         t.read( &v[0], 1 );
+         BOOST_CHECK_EQUAL( v[0], 'b' );
+
+         int x = 42, y = 0;
+         t.seek( 1 );
+         t.write( reinterpret_cast<char*>( &x ), sizeof( x ) );
+         t.seek( 1 );
+         t.read( reinterpret_cast<char*>( &y ), sizeof( y ) );
+         BOOST_CHECK_EQUAL( x, y );
+
+         BOOST_CHECK_THROW( t.read( &v[0], 3 ), std::ios_base::failure );
+         BOOST_CHECK( t.eof() );
+
+         t.close();
+         BOOST_CHECK( !t.is_open() );
+
+         // visible through stdio after close
+         cfile c;
+         c.set_file_path( t.get_file_path() );
+         c.open( "rb" );
+         y = 0;
+         c.seek( 1 );
+         c.read( reinterpret_cast<char*>( &y ), sizeof( y ) );
+         BOOST_CHECK_EQUAL( x, y );
+      }
+   }
+
+   BOOST_AUTO_TEST_CASE(test_append_mode)
+   {
+      fc::temp_file tmpfile;
+      fd_file t;
+      t.set_file_path( tmpfile.path() );
+      t.open( "ab+" );
+      BOOST_CHECK_EQUAL( t.tellp(), 0u );
+      t.write( "abc", 3 );
+      t.seek( 0 );
+      char c;
+      t.read( &c, 1 );
+      BOOST_CHECK_EQUAL( c, 'a' );
+      // writes in append mode always go to the end, as with fopen
+      t.write( "d", 1 );
+      BOOST_CHECK_EQUAL( t.tellp(), 4u );
+      t.seek( 0 );
+      t.write( "e", 1 );
+      BOOST_CHECK_EQUAL( t.tellp(), 5u );
+      t.close();
+
+      t.open( "rb" );
+      std::vector<char> v(5);
+      t.read( v.data(), v.size() );
+      BOOST_CHECK_EQUAL( std::string( v.data(), v.size() ), "abcde" );
+   }
+
+   BOOST_AUTO_TEST_CASE(test_positional)
+   {
+      fc::temp_file tmpfile;
+      fd_file t;
+      t.set_file_path( tmpfile.path() );
+      t.open( fd_file::truncate_rw_mode );
+
+      std::vector<char> data( 3*4096 + 17 );
+      for( size_t i = 0; i < data.size(); ++i )
+         data[i] = static_cast<char>( i * 7 );
+      t.write( data.data(), data.size() );
+      BOOST_CHECK_EQUAL( t.tellp(), data.size() );
+
+      // pread_at sees buffered writes and does not move the position
+      std::vector<char> out( 100 );
+      t.pread_at( 5000, out.data(), out.size() );
+      BOOST_CHECK( std::equal( out.begin(), out.end(), data.begin() + 5000 ) );
+      BOOST_CHECK_EQUAL( t.tellp(), data.size() );
+
+      // pwrite_at invalidates cached reads of the same range
+      t.seek( 4990 );
+      t.read( out.data(), 10 );
+      t.pwrite_at( 5000, "xyz", 3 );
+      t.read( out.data(), 3 );
+      BOOST_CHECK_EQUAL( std::string( out.data(), 3 ), "xyz" );
+
+      BOOST_CHECK_THROW( t.pread_at( data.size() - 1, out.data(), 2 ), std::ios_base::failure );
+   }
+
+   BOOST_AUTO_TEST_CASE(test_datastream)
+   {
+      fc::temp_file tmpfile;
+      std::vector<uint64_t> values{ 0, 1, 127, 128, 300, 1ull << 40 };
+      std::string str = "fd_file";
+      {
+         fd_file t;
+         t.set_file_path( tmpfile.path() );
+         t.open( fd_file::truncate_rw_mode );
+         auto packed = fc::raw::pack( std::make_pair( values, str ) );
+         t.write( packed.data(), packed.size() );
+      }
+
+      fd_file t;
+      t.set_file_path( tmpfile.path() );
+      t.open( fd_file::update_rw_mode );
+      auto ds = t.create_datastream();
+      std::vector<uint64_t> values2;
+      std::string str2;
+      fc::raw::unpack( ds, values2 );
+      fc::raw::unpack( ds, str2 );
+      BOOST_CHECK( values == values2 );
+      BOOST_CHECK_EQUAL( str, str2 );
+   }
+
+   BOOST_AUTO_TEST_CASE(test_direct_io)
+   {
+      fc::temp_file tmpfile;
+      fd_file t;
+      t.set_file_path( tmpfile.path() );
+      t.use_direct_io( true );
+      t.open( fd_file::truncate_rw_mode );
+
+      std::vector<char> data( 5*t.filesystem_block_size() + 123 );
+      for( size_t i = 0; i < data.size(); ++i )
+         data[i] = static_cast<char>( i * 13 );
+      for( size_t off = 0; off < data.size(); off += 1000 )
+         t.write( data.data() + off, std::min<size_t>( 1000, data.size() - off ) );
+      t.sync();
+
+      std::vector<char> out( data.size() );
+      t.seek( 0 );
+      t.read( out.data(), out.size() );
+      BOOST_CHECK( out == data );
+   }
+
+   BOOST_AUTO_TEST_CASE(test_hole_punching)
+   {
+      if(!fd_file::supports_hole_punching())
+         return;
+
+      fc::temp_file tmpfile;
+      fd_file file;
+      file.set_file_path(tmpfile.path());
+      file.open(fd_file::truncate_rw_mode);
+
+      const size_t bs = file.filesystem_block_size();
+      std::vector<char> a(bs, 'A'), b(bs, 'B'), c(bs, 'C'), nom(bs);
+      file.write(a.data(), a.size());
+      file.write(b.data(), b.size());
+      file.write(c.data(), c.size());
+
+      file.seek(bs);
+      file.read(nom.data(), nom.size());
+      BOOST_TEST_REQUIRE(nom == b);
+
+      file.punch_hole(bs, 2*bs);
+      file.seek(0);
+      file.read(nom.data(), nom.size());
+      BOOST_TEST_REQUIRE(nom == a);
+      file.read(nom.data(), nom.size());
+      BOOST_TEST_REQUIRE(nom != b);
+      file.read(nom.data(), nom.size());
+      BOOST_TEST_REQUIRE(nom == c);
+   }
+
+   BOOST_AUTO_TEST_CASE(benchmark)
+   {
+      static constexpr size_t num_entries = 2000; // 200000
+      static constexpr size_t entry_size = 256;
+
+      fc::temp_directory tempdir;
+      std::vector<char> entry( entry_size, 'x' );
+      std::mt19937 r( 0x1234 );
+      std::vector<size_t> offsets( num_entries );
+      for( auto& o : offsets )
+         o = ( r() % num_entries ) * entry_size;
+
+      auto run = [&]( auto& file, const char* name ) {
+         file.set_file_path( tempdir.path() / name );
+         file.open( "wb+" );
+
+         auto start = std::chrono::steady_clock::now();
+         for( size_t i = 0; i < num_entries; ++i )
+            file.write( entry.data(), entry.size() );
+         file.flush();
+         auto appended = std::chrono::steady_clock::now();
+         for( size_t o : offsets ) {
+            file.seek( o );
+            file.read( entry.data(), entry.size() );
+         }
+         auto end = std::chrono::steady_clock::now();
+
+         ilog( "${name}: sequential append ${a} ns/entry, random read ${r} ns/entry",
+               ("name", name)
+               ("a", std::chrono::duration_cast<std::chrono::nanoseconds>( appended - start ).count() / num_entries)
+               ("r", std::chrono::duration_cast<std::chrono::nanoseconds>( end - appended ).count() / num_entries) );
+      };
+
+      cfile c;
+      run( c, "cfile" );
+      fd_file f;
+      run( f, "fd_file" );
+   }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 
 #include <fc/io/json.hpp>
 #include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
 
 using namespace fc;
 
@@ -222,4 +223,57 @@ BOOST_AUTO_TEST_CASE(escape_string_test)
    }
 }
 
+BOOST_AUTO_TEST_CASE(deadline_yield_test)
+{
+   {  // deadline is checked on the first call, max_len on every call
+      json::deadline_yield expired( fc::time_point::min(), json::max_length_limit );
+      BOOST_CHECK_EXCEPTION( expired(0), fc::timeout_exception, json_test_util::time_except_verf_func );
+
+      json::deadline_yield limited( fc::time_point::maximum(), 10 );
+      for( uint32_t i = 0; i < json::deadline_yield::deadline_check_interval; ++i )
+         limited(10);
+      BOOST_CHECK_EXCEPTION( limited(11), fc::assert_exception, json_test_util::length_limit_except_verf_func );
+   }
+   {  // a deadline that passes during serialization is still caught
+      fc::variants arr;
+      for( uint32_t i = 0; i < 10000; ++i )
+         arr.emplace_back( fc::mutable_variant_object( "id", i )( "name", json_test_util::repeat_chars ) );
+      const fc::variant v( std::move( arr ) );
+      const auto deadline = fc::time_point::now() + fc::microseconds(1);
+      BOOST_CHECK_EXCEPTION( json::to_string( v, deadline ), fc::timeout_exception, json_test_util::time_except_verf_func );
+      BOOST_CHECK_EQUAL( json::to_string( v, fc::time_point::maximum() ), json::to_string( v, json_test_util::yield_no_limitation ) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(deadline_to_string_benchmark)
+{
+   fc::variants arr;
+   for( uint32_t i = 0; i < 1000; ++i )
+      arr.emplace_back( fc::mutable_variant_object( "id", i )( "name", "producer" )( "active", true ) );
+   const fc::variant v( std::move( arr ) );
+
+   const uint32_t loops = 20; // 1000
+   const auto deadline = fc::time_point::now() + fc::seconds(3600);
+
+   // what the deadline overloads did before deadline_yield: a delegate that reads the clock on every call
+   const json::yield_function_t yield = [&](size_t s) {
+      FC_CHECK_DEADLINE(deadline);
+      FC_ASSERT( s <= json::max_length_limit );
+   };
+   size_t total = 0;
+   auto start = fc::time_point::now();
+   for( uint32_t i = 0; i < loops; ++i )
+      total += json::to_string( v, yield ).size();
+   auto delegate_us = (fc::time_point::now() - start).count();
+
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < loops; ++i )
+      total -= json::to_string( v, deadline ).size();
+   auto policy_us = (fc::time_point::now() - start).count();
+
+   BOOST_CHECK_EQUAL( total, 0u );
+   ilog( "to_string of ${n} objects x ${l}: yield_function_t ${d} us, deadline_yield ${p} us",
+         ("n", 1000)("l", loops)("d", delegate_us)("p", policy_us) );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
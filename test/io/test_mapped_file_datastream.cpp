@@ -0,0 +1,114 @@
+#define BOOST_TEST_MODULE mapped_file_datastream
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/io/mapped_file_datastream.hpp>
+#include <fc/io/cfile.hpp>
+#include <fc/io/raw.hpp>
+
+using namespace fc;
+
+namespace {
+   void write_file( const fc::path& p, const std::vector<char>& data ) {
+      cfile f;
+      f.set_file_path( p );
+      f.open( cfile::truncate_rw_mode );
+      if( !data.empty() )
+         f.write( data.data(), data.size() );
+      f.close();
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(mapped_file_datastream_test_suite)
+
+BOOST_AUTO_TEST_CASE(unpack_whole_file) try {
+   fc::temp_file tmpfile;
+   std::vector<uint64_t> values{ 1, 2, 3, 1ull << 50 };
+   std::string str = "mapped";
+   std::vector<char> blob( 1000, 'z' );
+   std::vector<char> packed;
+   for( const auto& part : { fc::raw::pack( values ), fc::raw::pack( str ), fc::raw::pack( blob ), fc::raw::pack( uint32_t(7) ) } )
+      packed.insert( packed.end(), part.begin(), part.end() );
+   write_file( tmpfile.path(), packed );
+
+   mapped_file_datastream ds( tmpfile.path(), advice_random );
+   BOOST_CHECK_EQUAL( ds.size(), fc::file_size( tmpfile.path() ) );
+
+   std::vector<uint64_t> values2;
+   std::string str2;
+   fc::raw::unpack( ds, values2 );
+   fc::raw::unpack( ds, str2 );
+   BOOST_CHECK( values == values2 );
+   BOOST_CHECK_EQUAL( str, str2 );
+
+   // zero copy view of the blob
+   auto view = ds.read_bytes_view();
+   BOOST_CHECK_EQUAL( view.size(), blob.size() );
+   BOOST_CHECK( std::equal( view.begin(), view.end(), blob.begin() ) );
+
+   uint32_t last = 0;
+   fc::raw::unpack( ds, last );
+   BOOST_CHECK_EQUAL( last, 7u );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+
+   BOOST_CHECK_THROW( fc::raw::unpack( ds, last ), fc::out_of_range_exception );
+   BOOST_CHECK_THROW( ds.skip( 1 ), fc::out_of_range_exception );
+
+   // seek back and re-read
+   ds.seekp( 0 );
+   values2.clear();
+   fc::raw::unpack( ds, values2 );
+   BOOST_CHECK( values == values2 );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(windowed) try {
+   fc::temp_file tmpfile;
+   const uint64_t count = ( 5 * mapped_file_datastream::window_alignment + 123 ) / sizeof( uint64_t );
+   std::vector<char> data( count * sizeof( uint64_t ) );
+   for( uint64_t i = 0; i < count; ++i )
+      memcpy( data.data() + i * sizeof( uint64_t ), &i, sizeof( i ) );
+   write_file( tmpfile.path(), data );
+
+   for( size_t window : { size_t(1), 2 * mapped_file_datastream::window_alignment, size_t(0) } ) {
+      mapped_file_datastream ds( tmpfile.path(), advice_sequential, window );
+      uint64_t v = 0;
+      bool ok = true;
+      for( uint64_t i = 0; i < count; ++i ) {
+         fc::raw::unpack( ds, v );
+         ok = ok && v == i;
+      }
+      BOOST_CHECK( ok );
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+
+      // a read that straddles a window boundary
+      const size_t boundary = mapped_file_datastream::window_alignment;
+      ds.seekp( boundary - 4 );
+      std::vector<char> out( 8 );
+      ds.read( out.data(), out.size() );
+      BOOST_CHECK( std::equal( out.begin(), out.end(), data.begin() + boundary - 4 ) );
+
+      // views may straddle a window boundary as long as they fit in one window
+      ds.seekp( boundary - 4 );
+      const char* p = ds.read_view( 8 );
+      BOOST_CHECK( std::equal( p, p + 8, data.begin() + boundary - 4 ) );
+
+      ds.seekp( 0 );
+      ds.skip( data.size() - 8 );
+      fc::raw::unpack( ds, v );
+      BOOST_CHECK_EQUAL( v, count - 1 );
+   }
+
+   mapped_file_datastream small( tmpfile.path(), advice_sequential, 1 );
+   BOOST_CHECK_THROW( small.read_view( 2 * mapped_file_datastream::window_alignment ), fc::assert_exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(empty_file) try {
+   fc::temp_file tmpfile;
+   write_file( tmpfile.path(), {} );
+
+   mapped_file_datastream ds( tmpfile.path() );
+   BOOST_CHECK_EQUAL( ds.size(), 0u );
+   char c;
+   BOOST_CHECK_THROW( ds.get( c ), fc::out_of_range_exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,805 @@
+#define BOOST_TEST_MODULE raw
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/io/raw_fwd.hpp>
+
+// overloads for a reflected type must be declared before raw.hpp for the reflected visitors to find them
+namespace raw_test { struct custom_packed; struct misdeclared; }
+namespace fc { namespace raw {
+   template<typename Stream> void pack( Stream& s, const raw_test::custom_packed& v );
+   template<typename Stream> void unpack( Stream& s, raw_test::custom_packed& v );
+   template<typename Stream> void pack( Stream& s, const raw_test::misdeclared& v );
+   template<typename Stream> void unpack( Stream& s, raw_test::misdeclared& v );
+} }
+
+#include <fc/io/raw.hpp>
+#include <fc/io/raw_parallel.hpp>
+#include <fc/crypto/sha256.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace fc;
+
+namespace raw_test {
+   enum class status : uint8_t { pending, accepted, rejected };
+
+   struct header {
+      fc::time_point_sec timestamp;
+      uint64_t           producer = 0;
+      uint16_t           confirmed = 0;
+      fc::sha256         previous;
+      fc::sha256         transaction_mroot;
+      fc::sha256         action_mroot;
+      uint32_t           schedule_version = 0;
+
+      bool operator==( const header& o ) const {
+         return timestamp == o.timestamp && producer == o.producer && confirmed == o.confirmed && previous == o.previous &&
+                transaction_mroot == o.transaction_mroot && action_mroot == o.action_mroot && schedule_version == o.schedule_version;
+      }
+   };
+
+   struct signed_header : header {
+      std::array<char, 65> signature{};
+      status               state = status::pending;
+      bool                 irreversible = false;
+   };
+
+   struct named {
+      std::string name;
+      uint32_t    id = 0;
+   };
+
+   enum class color : int32_t { red, green, blue };
+
+   /// arrays of reflected enums are written element by element as sizeof(color), not as int64_t
+   struct palette {
+      uint32_t             a = 0;
+      std::array<color, 2> c{};
+      fc::array<color, 3>  d{};
+      uint32_t             b = 0;
+   };
+
+   /// reflected, but packed by its own overloads as a single byte
+   struct custom_packed {
+      uint32_t value = 0;
+   };
+
+   struct with_custom {
+      uint32_t      a = 0;
+      custom_packed c;
+      uint32_t      b = 0;
+   };
+
+   /// packed as a single byte, but wrongly declares a static pack size of 4 below
+   struct misdeclared {
+      uint32_t value = 0;
+   };
+
+   struct with_misdeclared {
+      uint32_t    a = 0;
+      misdeclared m;
+   };
+
+   struct initialized : fc::reflect_init {
+      uint32_t value = 0;
+      uint32_t doubled = 0;
+      void reflector_init() { doubled = value * 2; }
+   };
+
+   /// forwards to a datastream<const char*> so that unpack takes the generic, per field checked path
+   class forwarding_stream {
+   public:
+      forwarding_stream( const char* p, size_t s ) : ds( p, s ) {}
+      bool   read( char* d, size_t s ) { return ds.read( d, s ); }
+      bool   get( char& c ) { return ds.get( c ); }
+      bool   get( unsigned char& c ) { return ds.get( c ); }
+      void   skip( size_t s ) { ds.skip( s ); }
+      size_t tellp() const { return ds.tellp(); }
+      size_t remaining() const { return ds.remaining(); }
+   private:
+      fc::datastream<const char*> ds;
+   };
+
+   /// the byte at a time varint encoding fc::raw used before the word sized kernels
+   std::vector<char> byte_loop_pack( uint32_t val ) {
+      std::vector<char> out;
+      do {
+         uint8_t b = uint8_t(val) & 0x7f;
+         val >>= 7;
+         b |= ((val > 0) << 7);
+         out.push_back( char(b) );
+      } while( val );
+      return out;
+   }
+
+   uint32_t zigzag( int32_t v ) { return (uint32_t(v)<<1) ^ uint32_t(v>>31); }
+
+   /// the byte at a time unsigned_int decoding, returns the number of bytes consumed
+   size_t byte_loop_unpack( const char* p, uint32_t& value ) {
+      uint64_t v = 0; char b = 0; uint8_t by = 0; size_t n = 0;
+      do {
+         b = p[n++];
+         v |= uint32_t(uint8_t(b) & 0x7f) << by;
+         by += 7;
+      } while( uint8_t(b) & 0x80 && by < 32 );
+      value = static_cast<uint32_t>(v);
+      return n;
+   }
+
+   header make_header( uint32_t i ) {
+      header h;
+      h.timestamp = fc::time_point_sec( 1600000000 + i );
+      h.producer = 0x5530ea0000000000ull + i;
+      h.confirmed = i % 13;
+      h.previous = fc::sha256::hash( std::to_string( i ) );
+      h.transaction_mroot = fc::sha256::hash( h.previous );
+      h.action_mroot = fc::sha256::hash( h.transaction_mroot );
+      h.schedule_version = i / 100;
+      return h;
+   }
+   struct action {
+      uint64_t          account = 0;
+      uint64_t          name = 0;
+      std::vector<char> data;
+   };
+
+   struct transaction_header {
+      fc::time_point_sec expiration;
+      uint16_t           ref_block_num = 0;
+      uint32_t           ref_block_prefix = 0;
+      bool               delayed = false;
+   };
+
+   struct transaction : transaction_header {
+      std::vector<action>                     actions;
+      std::optional<std::string>              memo;
+      std::variant<uint64_t, std::string>     extension;
+      std::vector<std::pair<uint16_t, named>> extensions;
+   };
+
+   transaction make_transaction( std::mt19937& rng, uint32_t i ) {
+      transaction t;
+      t.expiration = fc::time_point_sec( 1600000000 + i );
+      t.ref_block_num = i;
+      t.ref_block_prefix = rng();
+      t.delayed = i % 3 == 0;
+      t.actions.resize( 1 + rng() % 4 );
+      for( auto& a : t.actions ) {
+         a.account = rng();
+         a.name = rng();
+         a.data.resize( rng() % 300, char( i ) );
+      }
+      if( i % 2 )
+         t.memo = std::string( rng() % 40, 'm' );
+      if( i % 5 )
+         t.extension = uint64_t( i );
+      else
+         t.extension = std::string( "ext" );
+      if( i % 7 == 0 )
+         t.extensions.emplace_back( uint16_t( i ), named{ "n", i } );
+      return t;
+   }
+}
+
+FC_REFLECT_ENUM( raw_test::status, (pending)(accepted)(rejected) )
+FC_REFLECT( raw_test::header, (timestamp)(producer)(confirmed)(previous)(transaction_mroot)(action_mroot)(schedule_version) )
+FC_REFLECT_DERIVED( raw_test::signed_header, (raw_test::header), (signature)(state)(irreversible) )
+FC_REFLECT( raw_test::named, (name)(id) )
+FC_REFLECT_ENUM( raw_test::color, (red)(green)(blue) )
+FC_REFLECT( raw_test::palette, (a)(c)(d)(b) )
+FC_REFLECT( raw_test::custom_packed, (value) )
+FC_REFLECT( raw_test::with_custom, (a)(c)(b) )
+FC_REFLECT( raw_test::misdeclared, (value) )
+FC_REFLECT( raw_test::with_misdeclared, (a)(m) )
+FC_REFLECT( raw_test::initialized, (value) )
+FC_REFLECT( raw_test::action, (account)(name)(data) )
+FC_REFLECT( raw_test::transaction_header, (expiration)(ref_block_num)(ref_block_prefix)(delayed) )
+FC_REFLECT_DERIVED( raw_test::transaction, (raw_test::transaction_header), (actions)(memo)(extension)(extensions) )
+
+namespace fc { namespace raw {
+   template<typename Stream>
+   void pack( Stream& s, const raw_test::custom_packed& v ) { fc::raw::pack( s, uint8_t( v.value ) ); }
+   template<typename Stream>
+   void unpack( Stream& s, raw_test::custom_packed& v ) { uint8_t b = 0; fc::raw::unpack( s, b ); v.value = b; }
+   template<typename Stream>
+   void pack( Stream& s, const raw_test::misdeclared& v ) { fc::raw::pack( s, uint8_t( v.value ) ); }
+   template<typename Stream>
+   void unpack( Stream& s, raw_test::misdeclared& v ) { uint8_t b = 0; fc::raw::unpack( s, b ); v.value = b; }
+   template<> struct static_pack_size<raw_test::misdeclared> : std::integral_constant<size_t, 4> {};
+} }
+
+using namespace raw_test;
+
+BOOST_AUTO_TEST_SUITE(raw_test_suite)
+
+BOOST_AUTO_TEST_CASE(static_pack_size) {
+   static_assert( fc::raw::static_pack_size<uint16_t>::value == 2 );
+   static_assert( fc::raw::static_pack_size<bool>::value == 1 );
+   static_assert( fc::raw::static_pack_size<status>::value == 8 );
+   static_assert( fc::raw::static_pack_size<fc::sha256>::value == 32 );
+   static_assert( fc::raw::static_pack_size<header>::value == 4 + 8 + 2 + 3*32 + 4 );
+   static_assert( fc::raw::static_pack_size<signed_header>::value == fc::raw::static_pack_size<header>::value + 65 + 8 + 1 );
+   static_assert( fc::raw::static_pack_size<std::pair<uint32_t, header>>::value == 4 + fc::raw::static_pack_size<header>::value );
+   static_assert( fc::raw::static_pack_size<fc::array<uint64_t, 3>>::value == 24 );
+   static_assert( fc::raw::static_pack_size<std::string>::value == 0 );
+   static_assert( fc::raw::static_pack_size<named>::value == 0 );
+   static_assert( fc::raw::static_pack_size<std::pair<uint32_t, named>>::value == 0 );
+   static_assert( fc::raw::static_pack_size<std::vector<header>>::value == 0 );
+   static_assert( fc::raw::static_pack_size<fc::unsigned_int>::value == 0 );
+   static_assert( fc::raw::static_pack_size<std::array<color, 2>>::value == 2 * sizeof(color) );
+   static_assert( fc::raw::static_pack_size<fc::array<color, 3>>::value == 3 * sizeof(color) );
+   static_assert( fc::raw::static_pack_size<palette>::value == 4 + 5 * sizeof(color) + 4 );
+   static_assert( fc::raw::static_pack_size<custom_packed>::value == 0 );
+   static_assert( fc::raw::static_pack_size<with_custom>::value == 0 );
+
+   signed_header h;
+   static_cast<header&>( h ) = make_header( 7 );
+   BOOST_CHECK_EQUAL( fc::raw::pack_size( h ), fc::raw::static_pack_size<signed_header>::value );
+   BOOST_CHECK_EQUAL( fc::raw::pack_size( h.timestamp ), fc::raw::static_pack_size<fc::time_point_sec>::value );
+   BOOST_CHECK_EQUAL( fc::raw::pack_size( fc::time_point() ), fc::raw::static_pack_size<fc::time_point>::value );
+}
+
+BOOST_AUTO_TEST_CASE(prevalidated_unpack) try {
+   signed_header h;
+   static_cast<header&>( h ) = make_header( 42 );
+   h.signature.fill( 's' );
+   h.state = status::rejected;
+   h.irreversible = true;
+   std::vector<char> packed = fc::raw::pack( h );
+   packed.push_back( 'x' );
+
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   signed_header h2;
+   fc::raw::unpack( ds, h2 );
+   BOOST_CHECK( static_cast<const header&>( h ) == static_cast<const header&>( h2 ) );
+   BOOST_CHECK( h.signature == h2.signature );
+   BOOST_CHECK( h2.state == status::rejected );
+   BOOST_CHECK( h2.irreversible );
+   BOOST_CHECK_EQUAL( ds.tellp(), packed.size() - 1 );
+   char c;
+   ds.get( c );
+   BOOST_CHECK_EQUAL( c, 'x' );
+
+   // same result through the generic path
+   forwarding_stream fs( packed.data(), packed.size() );
+   signed_header h3;
+   fc::raw::unpack( fs, h3 );
+   BOOST_CHECK( static_cast<const header&>( h ) == static_cast<const header&>( h3 ) );
+   BOOST_CHECK_EQUAL( fs.tellp(), packed.size() - 1 );
+
+   // vectors of fixed size objects take the fast path per element
+   std::vector<header> headers;
+   for( uint32_t i = 0; i < 10; ++i )
+      headers.push_back( make_header( i ) );
+   std::vector<char> packed_headers = fc::raw::pack( headers );
+   std::vector<header> headers2 = fc::raw::unpack<std::vector<header>>( packed_headers );
+   BOOST_CHECK( headers == headers2 );
+
+   // validation done by field unpack still applies
+   packed[packed.size() - 2] = 5;
+   fc::datastream<const char*> bad( packed.data(), packed.size() );
+   BOOST_CHECK_THROW( fc::raw::unpack( bad, h2 ), fc::assert_exception );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(prevalidated_unpack_matches_pack_overloads) try {
+   palette p;
+   p.a = 1;
+   p.c = { color::green, color::blue };
+   p.d.data[2] = color::blue;
+   p.b = 2;
+   fc::datastream<std::vector<char>> generic;
+   fc::raw::pack( generic, p );
+   const std::vector<char>& expected = generic.storage();
+   BOOST_REQUIRE_EQUAL( expected.size(), fc::raw::static_pack_size<palette>::value );
+
+   fc::datastream<const char*> ds( expected.data(), expected.size() );
+   palette p2;
+   fc::raw::unpack( ds, p2 );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   BOOST_CHECK( p2.c == p.c );
+   BOOST_CHECK( p2.d.data[2] == color::blue );
+   BOOST_CHECK_EQUAL( p2.b, 2u );
+
+   with_custom w{ 3, { 4 }, 5 };
+   fc::datastream<std::vector<char>> generic_custom;
+   fc::raw::pack( generic_custom, w );
+   BOOST_REQUIRE_EQUAL( generic_custom.storage().size(), 4 + 1 + 4u );
+   fc::datastream<const char*> cs( generic_custom.storage().data(), generic_custom.storage().size() );
+   with_custom w2;
+   fc::raw::unpack( cs, w2 );
+   BOOST_CHECK_EQUAL( cs.remaining(), 0u );
+   BOOST_CHECK_EQUAL( w2.c.value, 4u );
+   BOOST_CHECK_EQUAL( w2.b, 5u );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(prevalidated_unpack_truncated) try {
+   std::vector<char> packed = fc::raw::pack( make_header( 1 ) );
+   for( size_t len : { size_t(0), size_t(1), packed.size() / 2, packed.size() - 1 } ) {
+      fc::datastream<const char*> ds( packed.data(), len );
+      header h;
+      BOOST_CHECK_THROW( fc::raw::unpack( ds, h ), fc::out_of_range_exception );
+      BOOST_CHECK_EQUAL( ds.tellp(), 0u );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(prevalidated_unpack_calls_reflector_init) try {
+   initialized i;
+   i.value = 21;
+   std::vector<char> packed = fc::raw::pack( i );
+   BOOST_CHECK_EQUAL( packed.size(), fc::raw::static_pack_size<initialized>::value );
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   initialized i2;
+   fc::raw::unpack( ds, i2 );
+   BOOST_CHECK_EQUAL( i2.value, 21u );
+   BOOST_CHECK_EQUAL( i2.doubled, 42u );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(unsigned_int_decode) try {
+   std::vector<uint32_t> values{ 0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0x1fffff, 0x200000, 0xfffffff, 0x10000000,
+                                 0x7fffffff, 0x80000000, 0xffffffff };
+   for( uint32_t v : values ) {
+      std::vector<char> packed = fc::raw::pack( fc::unsigned_int( v ) );
+      // at the very end of the buffer, so the generic loop decodes it, and with trailing bytes for the fast path
+      for( size_t pad : { 0, 1, 8 } ) {
+         std::vector<char> buf = packed;
+         buf.resize( packed.size() + pad, char(0xff) );
+         fc::datastream<const char*> ds( buf.data(), buf.size() );
+         fc::unsigned_int out;
+         fc::raw::unpack( ds, out );
+         BOOST_CHECK_EQUAL( out.value, v );
+         BOOST_CHECK_EQUAL( ds.tellp(), packed.size() );
+      }
+   }
+
+   // encodings longer than 5 bytes stop after the fifth byte and keep its low bits, as the byte loop does
+   std::vector<char> overlong{ char(0xff), char(0xff), char(0xff), char(0xff), char(0xff), char(0x01), 0, 0 };
+   for( size_t len : { size_t(5), overlong.size() } ) {
+      fc::datastream<const char*> ds( overlong.data(), len );
+      forwarding_stream fs( overlong.data(), len );
+      fc::unsigned_int fast, generic;
+      fc::raw::unpack( ds, fast );
+      fc::raw::unpack( fs, generic );
+      BOOST_CHECK_EQUAL( fast.value, generic.value );
+      BOOST_CHECK_EQUAL( ds.tellp(), 5u );
+      BOOST_CHECK_EQUAL( fs.tellp(), 5u );
+   }
+
+   std::vector<char> truncated{ char(0x80), char(0x80) };
+   fc::datastream<const char*> ds( truncated.data(), truncated.size() );
+   fc::unsigned_int out;
+   BOOST_CHECK_THROW( fc::raw::unpack( ds, out ), fc::out_of_range_exception );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(prevalidated_unpack_benchmark) try {
+   constexpr size_t num_headers = 10000; // 1000000
+   std::vector<signed_header> headers( num_headers );
+   for( uint32_t i = 0; i < num_headers; ++i )
+      static_cast<header&>( headers[i] ) = make_header( i );
+   std::vector<char> packed = fc::raw::pack( headers );
+
+   auto run = [&]( auto&& make_stream ) {
+      std::vector<signed_header> out;
+      auto start = std::chrono::steady_clock::now();
+      auto ds = make_stream();
+      fc::raw::unpack( ds, out );
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+      BOOST_REQUIRE_EQUAL( out.size(), num_headers );
+      BOOST_CHECK( static_cast<const header&>( out.back() ) == static_cast<const header&>( headers.back() ) );
+      return ns / num_headers;
+   };
+
+   auto checked_ns = run( [&]() { return forwarding_stream( packed.data(), packed.size() ); } );
+   auto prevalidated_ns = run( [&]() { return fc::datastream<const char*>( packed.data(), packed.size() ); } );
+   ilog( "signed header unpack: per field checks ${c} ns, prevalidated ${p} ns", ("c", checked_ns)("p", prevalidated_ns) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(varint_matches_byte_loop) try {
+   std::mt19937_64 rng( 37 );
+   std::vector<uint32_t> values{ 0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0x1fffff, 0x200000, 0xfffffff, 0x10000000,
+                                 0x7fffffff, 0x80000000, 0xffffffff };
+   for( int i = 0; i < 100000; ++i )
+      values.push_back( uint32_t( rng() >> ( rng() % 64 ) ) );
+
+   for( uint32_t v : values ) {
+      const std::vector<char> expected = byte_loop_pack( v );
+      BOOST_REQUIRE( fc::raw::pack( fc::unsigned_int( v ) ) == expected );
+      BOOST_REQUIRE( fc::raw::pack( fc::signed_int( int32_t( v ) ) ) == byte_loop_pack( zigzag( int32_t( v ) ) ) );
+      BOOST_REQUIRE_EQUAL( fc::raw::pack_size( fc::unsigned_int( v ) ), expected.size() );
+
+      // packing in place leaves the following bytes untouched
+      std::vector<char> in_place( 16, 'q' );
+      fc::datastream<char*> ws( in_place.data(), in_place.size() );
+      fc::raw::pack( ws, fc::unsigned_int( v ) );
+      BOOST_REQUIRE_EQUAL( ws.tellp(), expected.size() );
+      BOOST_REQUIRE( std::equal( expected.begin(), expected.end(), in_place.begin() ) );
+      BOOST_REQUIRE( std::all_of( in_place.begin() + expected.size(), in_place.end(), []( char c ) { return c == 'q'; } ) );
+
+      // through the kernel with trailing bytes and through the byte loop at the end of the buffer
+      std::vector<char> buf = expected;
+      buf.resize( expected.size() + 8, char( rng() ) );
+      for( size_t len : { expected.size(), buf.size() } ) {
+         fc::datastream<const char*> ds( buf.data(), len );
+         fc::unsigned_int u;
+         fc::raw::unpack( ds, u );
+         BOOST_REQUIRE_EQUAL( u.value, v );
+         BOOST_REQUIRE_EQUAL( ds.tellp(), expected.size() );
+      }
+   }
+   for( uint32_t v : values ) {
+      const int32_t sv = int32_t( v );
+      std::vector<char> buf = fc::raw::pack( fc::signed_int( sv ) );
+      const size_t len = buf.size();
+      buf.resize( len + 8, char(0x80) );
+      fc::datastream<const char*> ds( buf.data(), buf.size() );
+      fc::signed_int out;
+      fc::raw::unpack( ds, out );
+      BOOST_REQUIRE_EQUAL( out.value, sv );
+      BOOST_REQUIRE_EQUAL( ds.tellp(), len );
+   }
+
+   // arbitrary bytes, including overlong and non-canonical encodings, decode as the byte loop does
+   for( int i = 0; i < 100000; ++i ) {
+      char buf[8];
+      uint64_t r = rng() | ( i % 2 ? 0x0000008080808080ull : 0 );
+      memcpy( buf, &r, sizeof(buf) );
+      uint32_t expected;
+      const size_t expected_len = byte_loop_unpack( buf, expected );
+      fc::datastream<const char*> ds( buf, sizeof(buf) );
+      fc::unsigned_int u;
+      fc::raw::unpack( ds, u );
+      BOOST_REQUIRE_EQUAL( u.value, expected );
+      BOOST_REQUIRE_EQUAL( ds.tellp(), expected_len );
+   }
+
+   // signed_int encodings longer than 5 bytes are left to the byte loop
+   std::vector<char> long_signed{ char(0x82), char(0x80), char(0x80), char(0x80), char(0x80), char(0x00), 0, 0, 0 };
+   fc::datastream<const char*> ds( long_signed.data(), long_signed.size() );
+   fc::signed_int out;
+   fc::raw::unpack( ds, out );
+   BOOST_CHECK_EQUAL( out.value, 1 );
+   BOOST_CHECK_EQUAL( ds.tellp(), 6u );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(varint_benchmark) try {
+   constexpr size_t num_varints = 100000; // 10000000
+   std::vector<fc::unsigned_int> values;
+   std::mt19937 rng( 38 );
+   for( size_t i = 0; i < num_varints; ++i )
+      values.emplace_back( uint32_t( rng() ) >> ( rng() % 32 ) );
+
+   auto elapsed_ps = []( auto start ) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() * 1000 / num_varints;
+   };
+
+   std::vector<char> reference;
+   for( const auto& v : values ) {
+      auto b = byte_loop_pack( v.value );
+      reference.insert( reference.end(), b.begin(), b.end() );
+   }
+
+   // the previous encoder, one stream call per byte
+   std::vector<char> varints( reference.size() );
+   auto start = std::chrono::steady_clock::now();
+   {
+      fc::datastream<char*> ds( varints.data(), varints.size() );
+      for( const auto& v : values ) {
+         uint32_t val = v.value;
+         do {
+            uint8_t b = uint8_t(val) & 0x7f;
+            val >>= 7;
+            b |= ((val > 0) << 7);
+            ds.write( (char*)&b, 1 );
+         } while( val );
+      }
+   }
+   auto reference_ps = elapsed_ps( start );
+   BOOST_CHECK( varints == reference );
+
+   start = std::chrono::steady_clock::now();
+   {
+      fc::datastream<char*> ds( varints.data(), varints.size() );
+      for( const auto& v : values )
+         fc::raw::pack( ds, v );
+   }
+   auto pack_ps = elapsed_ps( start );
+   BOOST_CHECK( varints == reference );
+
+   auto run_unpack = [&]( auto ds ) {
+      uint64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for( size_t i = 0; i < num_varints; ++i ) {
+         fc::unsigned_int v;
+         fc::raw::unpack( ds, v );
+         sum += v.value;
+      }
+      auto ps = elapsed_ps( start );
+      BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+      return std::make_pair( sum, ps );
+   };
+   auto generic = run_unpack( forwarding_stream( varints.data(), varints.size() ) );
+   auto fast = run_unpack( fc::datastream<const char*>( varints.data(), varints.size() ) );
+   BOOST_CHECK_EQUAL( generic.first, fast.first );
+   ilog( "unsigned_int pack: byte loop ${r} ps, kernel ${p} ps", ("r", reference_ps)("p", pack_ps) );
+   ilog( "unsigned_int unpack: byte loop ${g} ps, kernel ${f} ps", ("g", generic.second)("f", fast.second) );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(skip_matches_pack_size) try {
+   std::mt19937 rng( 39 );
+   for( uint32_t i = 0; i < 200; ++i ) {
+      transaction t = make_transaction( rng, i );
+      std::vector<char> packed = fc::raw::pack( t );
+      packed.push_back( 'x' );
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::raw::skip<transaction>( ds );
+      BOOST_REQUIRE_EQUAL( ds.tellp(), packed.size() - 1 );
+
+      fc::datastream<const char*> truncated( packed.data(), packed.size() - 2 );
+      BOOST_REQUIRE_THROW( fc::raw::skip<transaction>( truncated ), fc::out_of_range_exception );
+   }
+
+   std::vector<char> packed = fc::raw::pack( std::variant<uint64_t, std::string>( std::string( "abc" ) ) );
+   packed[0] = 2;
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   BOOST_CHECK_THROW( ( fc::raw::skip<std::variant<uint64_t, std::string>>( ds ) ), fc::assert_exception );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(unpack_parallel) try {
+   std::mt19937 rng( 40 );
+   for( size_t n : { 0, 1, 3, 1000 } ) {
+      std::vector<transaction> trxs;
+      for( uint32_t i = 0; i < n; ++i )
+         trxs.push_back( make_transaction( rng, i ) );
+      std::vector<char> packed = fc::raw::pack( trxs );
+      packed.push_back( 'x' );
+
+      for( size_t threads : { 1, 4 } ) {
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         std::vector<transaction> out( 5 );
+         fc::raw::unpack_parallel( ds, out, threads );
+         BOOST_REQUIRE_EQUAL( out.size(), n );
+         BOOST_REQUIRE( fc::raw::pack( out ) == fc::raw::pack( trxs ) );
+         BOOST_REQUIRE_EQUAL( ds.tellp(), packed.size() - 1 );
+      }
+   }
+
+   // fixed size elements
+   std::vector<header> headers;
+   for( uint32_t i = 0; i < 100; ++i )
+      headers.push_back( make_header( i ) );
+   std::vector<char> packed = fc::raw::pack( headers );
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   std::vector<header> out;
+   fc::raw::unpack_parallel( ds, out, 4 );
+   BOOST_CHECK( out == headers );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+
+   fc::datastream<const char*> truncated( packed.data(), packed.size() - 1 );
+   BOOST_CHECK_THROW( fc::raw::unpack_parallel( truncated, out, 4 ), fc::out_of_range_exception );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(skip_custom_packed_members) try {
+   // custom_packed is reflected but packs itself into one byte, so it cannot be skipped member by member
+   std::vector<with_custom> v;
+   for( uint32_t i = 0; i < 50; ++i )
+      v.push_back( with_custom{ i, { i + 1 }, i + 2 } );
+   std::vector<char> packed = fc::raw::pack( v );
+
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   fc::raw::skip<std::vector<with_custom>>( ds );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+
+   for( size_t threads : { 1, 4 } ) {
+      fc::datastream<const char*> ds2( packed.data(), packed.size() );
+      std::vector<with_custom> out;
+      fc::raw::unpack_parallel( ds2, out, threads );
+      BOOST_CHECK_EQUAL( ds2.remaining(), 0u );
+      BOOST_CHECK( fc::raw::pack( out ) == packed );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(unpack_parallel_reports_index) try {
+   std::mt19937 rng( 41 );
+   std::vector<transaction> trxs;
+   for( uint32_t i = 0; i < 20; ++i )
+      trxs.push_back( make_transaction( rng, i ) );
+   std::vector<char> packed = fc::raw::pack( trxs );
+
+   // the delayed flag of element 7 is skipped as part of a fixed size header, so only unpack sees it
+   size_t offset = fc::raw::pack_size( fc::unsigned_int( 20 ) );
+   for( size_t i = 0; i < 7; ++i )
+      offset += fc::raw::pack_size( trxs[i] );
+   packed[offset + 4 + 2 + 4] = 3;
+
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   std::vector<transaction> out;
+   try {
+      fc::raw::unpack_parallel( ds, out, 4 );
+      BOOST_FAIL( "expected exception" );
+   } catch( const fc::assert_exception& e ) {
+      BOOST_CHECK( e.to_detail_string().find( "error unpacking element 7 of" ) != std::string::npos );
+   }
+
+   // a bad variant index is found by the pre-pass
+   packed = fc::raw::pack( trxs );
+   offset = fc::raw::pack_size( fc::unsigned_int( 20 ) );
+   for( size_t i = 0; i < 12; ++i )
+      offset += fc::raw::pack_size( trxs[i] );
+   const auto& t = trxs[12];
+   offset += fc::raw::pack_size( static_cast<const transaction_header&>( t ) ) + fc::raw::pack_size( t.actions ) + fc::raw::pack_size( t.memo );
+   packed[offset] = 9;
+   fc::datastream<const char*> ds2( packed.data(), packed.size() );
+   try {
+      fc::raw::unpack_parallel( ds2, out, 4 );
+      BOOST_FAIL( "expected exception" );
+   } catch( const fc::assert_exception& e ) {
+      BOOST_CHECK( e.to_detail_string().find( "error skipping element 12 of" ) != std::string::npos );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(unpack_parallel_benchmark) try {
+   std::mt19937 rng( 42 );
+   const size_t threads = std::max( 2u, std::thread::hardware_concurrency() );
+   for( size_t n : { 1000, 10000 } ) {
+      std::vector<transaction> trxs;
+      for( uint32_t i = 0; i < n; ++i )
+         trxs.push_back( make_transaction( rng, i ) );
+      std::vector<char> packed = fc::raw::pack( trxs );
+
+      auto start = std::chrono::steady_clock::now();
+      std::vector<transaction> sequential;
+      fc::datastream<const char*> ds( packed.data(), packed.size() );
+      fc::raw::unpack( ds, sequential );
+      auto sequential_us = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+
+      start = std::chrono::steady_clock::now();
+      std::vector<transaction> parallel;
+      fc::datastream<const char*> pds( packed.data(), packed.size() );
+      fc::raw::unpack_parallel( pds, parallel, threads );
+      auto parallel_us = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+
+      BOOST_CHECK( fc::raw::pack( parallel ) == packed );
+      ilog( "${n} transactions, ${b} bytes: unpack ${s} us, unpack_parallel on ${t} threads ${p} us",
+            ("n", n)("b", packed.size())("s", sequential_us)("t", threads)("p", parallel_us) );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(compiled_serializer_matches_visitor) try {
+   std::mt19937 rng( 43 );
+   for( uint32_t i = 0; i < 200; ++i ) {
+      transaction t = make_transaction( rng, i );
+
+      // datastream<std::vector<char>> is not contiguous, so it takes the per field visitor
+      fc::datastream<std::vector<char>> generic;
+      fc::raw::pack( generic, t );
+      const std::vector<char>& expected = generic.storage();
+
+      BOOST_REQUIRE_EQUAL( fc::raw::pack_size( t ), expected.size() );
+      std::vector<char> packed( expected.size() );
+      fc::datastream<char*> ds( packed.data(), packed.size() );
+      fc::raw::pack( ds, t );
+      BOOST_REQUIRE( packed == expected );
+
+      std::vector<char> too_small( expected.size() - 1 );
+      fc::datastream<char*> small_ds( too_small.data(), too_small.size() );
+      BOOST_REQUIRE_THROW( fc::raw::pack( small_ds, t ), fc::out_of_range_exception );
+
+      transaction compiled, visited;
+      fc::datastream<const char*> rs( packed.data(), packed.size() );
+      fc::raw::unpack( rs, compiled );
+      forwarding_stream fs( packed.data(), packed.size() );
+      fc::raw::unpack( fs, visited );
+      BOOST_REQUIRE( fc::raw::pack( compiled ) == expected );
+      BOOST_REQUIRE( fc::raw::pack( visited ) == expected );
+   }
+
+   static_assert( fc::raw::detail::field_plan<transaction>::num_fields == 8 );
+   static_assert( fc::raw::detail::field_plan<transaction>::run_sizes[0] == 4 + 2 + 4 + 1 );
+   static_assert( fc::raw::detail::field_plan<transaction>::run_sizes[1] == 0 );
+   static_assert( fc::raw::detail::field_plan<transaction>::sizes[4] == 0 );
+
+   // errors still name the field, including fields read as part of a run
+   transaction t = make_transaction( rng, 1 );
+   std::vector<char> packed = fc::raw::pack( t );
+   packed[4 + 2 + 4] = 2;
+   fc::datastream<const char*> ds( packed.data(), packed.size() );
+   try {
+      fc::raw::unpack( ds, t );
+      BOOST_FAIL( "expected exception" );
+   } catch( const fc::assert_exception& e ) {
+      BOOST_CHECK( e.to_detail_string().find( "Error unpacking field delayed" ) != std::string::npos );
+   }
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(compiled_serializer_enum_arrays) try {
+   palette p;
+   p.a = 7;
+   p.c = { color::blue, color::green };
+   p.d.data[0] = color::green;
+   p.b = 9;
+
+   fc::datastream<std::vector<char>> generic;
+   fc::raw::pack( generic, p );
+   const std::vector<char>& expected = generic.storage();
+
+   BOOST_REQUIRE_EQUAL( fc::raw::pack_size( p ), expected.size() );
+   std::vector<char> packed( expected.size() );
+   fc::datastream<char*> ds( packed.data(), packed.size() );
+   fc::raw::pack( ds, p );
+   BOOST_CHECK_EQUAL( ds.remaining(), 0u );
+   BOOST_REQUIRE( packed == expected );
+
+   palette compiled, visited;
+   fc::datastream<const char*> rs( packed.data(), packed.size() );
+   fc::raw::unpack( rs, compiled );
+   forwarding_stream fs( packed.data(), packed.size() );
+   fc::raw::unpack( fs, visited );
+   BOOST_REQUIRE( fc::raw::pack( compiled ) == expected );
+   BOOST_REQUIRE( fc::raw::pack( visited ) == expected );
+
+   // a static_pack_size specialization that disagrees with the type's pack overload is caught at the end of the run
+   with_misdeclared m{ 1, { 2 } };
+   std::vector<char> buf( 4 + 4 );
+   fc::datastream<char*> ms( buf.data(), buf.size() );
+   BOOST_CHECK_THROW( fc::raw::pack( ms, m ), fc::assert_exception );
+   fc::datastream<const char*> mr( buf.data(), buf.size() );
+   BOOST_CHECK_THROW( fc::raw::unpack( mr, m ), fc::assert_exception );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(compiled_serializer_benchmark) try {
+   constexpr size_t num_transactions = 2000; // 100000
+   std::mt19937 rng( 44 );
+   std::vector<transaction> trxs;
+   for( uint32_t i = 0; i < num_transactions; ++i )
+      trxs.push_back( make_transaction( rng, i ) );
+   std::vector<signed_header> headers( num_transactions );
+   for( uint32_t i = 0; i < num_transactions; ++i )
+      static_cast<header&>( headers[i] ) = make_header( i );
+
+   auto elapsed_ns = []( auto start ) {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count() / num_transactions;
+   };
+
+   auto run = [&]( const char* name, const auto& values ) {
+      using vector_type = std::decay_t<decltype( values )>;
+      const size_t size = fc::raw::pack_size( values );
+
+      auto start = std::chrono::steady_clock::now();
+      fc::datastream<std::vector<char>> generic;
+      generic.storage().reserve( size );
+      fc::raw::pack( generic, values );
+      auto generic_pack_ns = elapsed_ns( start );
+
+      std::vector<char> packed( size );
+      start = std::chrono::steady_clock::now();
+      fc::datastream<char*> ds( packed.data(), packed.size() );
+      fc::raw::pack( ds, values );
+      auto pack_ns = elapsed_ns( start );
+      BOOST_CHECK( packed == generic.storage() );
+
+      start = std::chrono::steady_clock::now();
+      BOOST_CHECK_EQUAL( fc::raw::pack_size( values ), size );
+      auto pack_size_ns = elapsed_ns( start );
+
+      vector_type visited, compiled;
+      start = std::chrono::steady_clock::now();
+      forwarding_stream fs( packed.data(), packed.size() );
+      fc::raw::unpack( fs, visited );
+      auto generic_unpack_ns = elapsed_ns( start );
+
+      start = std::chrono::steady_clock::now();
+      fc::datastream<const char*> rs( packed.data(), packed.size() );
+      fc::raw::unpack( rs, compiled );
+      auto unpack_ns = elapsed_ns( start );
+      BOOST_CHECK( fc::raw::pack( compiled ) == packed );
+
+      ilog( "${n}: pack visitor ${gp} ns, compiled ${p} ns, pack_size ${ps} ns; unpack visitor ${gu} ns, compiled ${u} ns",
+            ("n", name)("gp", generic_pack_ns)("p", pack_ns)("ps", pack_size_ns)("gu", generic_unpack_ns)("u", unpack_ns) );
+   };
+   run( "transaction", trxs );
+   run( "signed_header", headers );
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
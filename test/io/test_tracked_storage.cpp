@@ -10,6 +10,7 @@
 #include <boost/multi_index/global_fun.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <sstream>
+#include <chrono>
 
 using boost::multi_index_container;
 using namespace boost::multi_index;
@@ -37,6 +38,26 @@ struct test_size2 {
 
 FC_REFLECT( test_size2, (key)(time)(s) )
 
+// counts default constructions, i.e. items unpacked by read_chunked()
+struct counted_size {
+   uint64_t key = 0;
+   uint64_t s = 0;
+
+   counted_size() { ++constructed; }
+   counted_size(uint64_t key, uint64_t s) : key(key), s(s) {}
+
+   static inline size_t constructed = 0;
+};
+
+FC_REFLECT( counted_size, (key)(s) )
+
+typedef multi_index_container<
+   counted_size,
+   indexed_by<
+      hashed_unique< tag<by_key>, member<counted_size, uint64_t, &counted_size::key>, std::hash<uint64_t>>
+   >
+> counted_size_container;
+
 namespace fc::tracked {
   template<>
   size_t memory_size(const test_size& t) {
@@ -47,6 +68,11 @@ namespace fc::tracked {
   size_t memory_size(const test_size2& t) {
      return t.s;
   }
+
+  template<>
+  size_t memory_size(const counted_size& t) {
+     return t.s;
+  }
 }
 
 struct by_time;
@@ -219,4 +245,336 @@ BOOST_AUTO_TEST_CASE(write_read_file_storage_test) {
    BOOST_CHECK_EQUAL( content.tellp(), tellp );
 }
 
+BOOST_AUTO_TEST_CASE(crc32c_test) {
+   // standard check value for CRC-32C
+   BOOST_CHECK_EQUAL( fc::crc32c("123456789", 9), 0xE3069283u );
+   BOOST_CHECK_EQUAL( fc::crc32c("6789", 4, fc::crc32c("12345", 5)), 0xE3069283u );
+   BOOST_CHECK_EQUAL( fc::crc32c("", 0), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(chunked_write_read_file_storage_test) { try {
+   using tracked_storage1 = fc::tracked_storage<test_size_container>;
+   using tracked_storage2 = fc::tracked_storage<test_size2_container>;
+
+   tracked_storage1 storage1_1;
+   for (uint64_t k = 0; k < 100; ++k)
+      storage1_1.insert(test_size{ k, k % 7 + 1 });
+   tracked_storage2 storage2_1;
+   const auto now = fc::time_point::now();
+   storage2_1.insert(test_size2{ 3, now, 7 });
+   tracked_storage1 empty;
+
+   fc::temp_directory td;
+   auto out = fc::persistence_util::open_cfile_for_write(td.path(), "temp.dat");
+   fc::persistence_util::write_persistence_header(out, 0x12345678, 6);
+   storage1_1.write_chunked(out, 4, 7);
+   empty.write_chunked(out, 4, 7);
+   storage2_1.write_chunked(out, 4);
+   out.flush();
+   out.close();
+
+   for (size_t threads : { 1, 4 }) {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      BOOST_CHECK_EQUAL( fc::persistence_util::read_persistence_header(content, 0x12345678, 6, 6), 6u );
+
+      tracked_storage1 storage1_2;
+      BOOST_CHECK(storage1_2.read_chunked(content, 1000, threads));
+      BOOST_CHECK_EQUAL( storage1_2.index().size(), 100u );
+      BOOST_CHECK_EQUAL( storage1_2.memory_size(), storage1_1.memory_size() );
+      for (const auto& item : storage1_1.index()) {
+         auto itr = storage1_2.find(item.key);
+         BOOST_REQUIRE( itr != storage1_2.index().end() );
+         BOOST_CHECK_EQUAL( itr->s, item.s );
+      }
+
+      tracked_storage1 empty_2;
+      BOOST_CHECK(empty_2.read_chunked(content, 1000, threads));
+      BOOST_CHECK_EQUAL( empty_2.index().size(), 0u );
+
+      tracked_storage2 storage2_2;
+      BOOST_CHECK(storage2_2.read_chunked(content, 1000, threads));
+      BOOST_REQUIRE_EQUAL( storage2_2.index().size(), 1u );
+      BOOST_CHECK( storage2_2.index().begin()->time == now );
+
+      const auto tellp = content.tellp();
+      content.seek_end(0);
+      BOOST_CHECK_EQUAL( content.tellp(), tellp );
+   }
+
+   // max_memory truncation stops in file order and still skips past the section
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      fc::persistence_util::read_persistence_header(content, 0x12345678, 6, 6);
+      tracked_storage1 storage1_2;
+      BOOST_CHECK(!storage1_2.read_chunked(content, 50, 2));
+      BOOST_CHECK_GE( storage1_2.memory_size(), 50u );
+      size_t expected_items = 0, expected_memory = 0;
+      for (const auto& item : storage1_1.index()) {
+         if (expected_memory >= 50)
+            break;
+         expected_memory += item.s;
+         ++expected_items;
+      }
+      BOOST_CHECK_EQUAL( storage1_2.index().size(), expected_items );
+      BOOST_CHECK_EQUAL( storage1_2.memory_size(), expected_memory );
+
+      tracked_storage1 empty_2;
+      BOOST_CHECK(empty_2.read_chunked(content, 1000, 2));
+      tracked_storage2 storage2_2;
+      BOOST_CHECK(storage2_2.read_chunked(content, 1000, 2));
+      BOOST_CHECK_EQUAL( storage2_2.index().size(), 1u );
+   }
+
+   // corrupt the last byte of the first section's data
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      fc::persistence_util::read_persistence_header(content, 0x12345678, 6, 6);
+      auto table = fc::persistence_util::read_chunk_table(content);
+      const size_t pos = content.tellp() + table.data_size() - 1;
+      content.close();
+
+      content.open(fc::cfile::update_rw_mode);
+      content.seek(pos);
+      char c = content.getc();
+      c ^= 0x01;
+      content.seek(pos);
+      content.write(&c, 1);
+      content.close();
+
+      content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      fc::persistence_util::read_persistence_header(content, 0x12345678, 6, 6);
+      tracked_storage1 storage1_2;
+      BOOST_CHECK_THROW(storage1_2.read_chunked(content, 1000, 2), fc::parse_error_exception);
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(chunked_read_stops_unpacking_at_max_memory) { try {
+   using tracked_storage = fc::tracked_storage<counted_size_container>;
+   constexpr size_t chunk_items = 16;
+
+   tracked_storage storage;
+   for (uint64_t k = 0; k < 2000; ++k)
+      storage.insert(counted_size{ k, k % 7 + 1 });
+
+   fc::temp_directory td;
+   auto out = fc::persistence_util::open_cfile_for_write(td.path(), "temp.dat");
+   storage.write_chunked(out, 4, chunk_items);
+   out.flush();
+   out.close();
+
+   // max_memory is reached inside a wave of 4 chunks
+   for (size_t max_memory : { size_t(1), size_t(20), size_t(300) }) {
+      size_t expected_items = 0, expected_memory = 0;
+      for (const auto& item : storage.index()) {
+         if (expected_memory >= max_memory)
+            break;
+         expected_memory += item.s;
+         ++expected_items;
+      }
+
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      content.seek(0);
+      tracked_storage storage2;
+      counted_size::constructed = 0;
+      BOOST_CHECK(!storage2.read_chunked(content, max_memory, 4));
+      BOOST_CHECK_EQUAL( storage2.index().size(), expected_items );
+      BOOST_CHECK_EQUAL( storage2.memory_size(), expected_memory );
+      // at most the chunk crossing max_memory is unpacked past it, not a whole wave
+      BOOST_CHECK_LE( counted_size::constructed, expected_items + chunk_items );
+      for (const auto& item : storage2.index())
+         BOOST_CHECK_EQUAL( item.s, item.key % 7 + 1 );
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(chunked_read_rejects_bad_tables) { try {
+   using tracked_storage1 = fc::tracked_storage<test_size_container>;
+   fc::temp_directory td;
+
+   const auto write = [&](const fc::persistence_util::chunk_table& table, const std::vector<char>& data) {
+      auto out = fc::persistence_util::open_cfile_for_write(td.path(), "temp.dat");
+      fc::persistence_util::write_chunk_table(out, table);
+      out.write(data.data(), data.size());
+      out.flush();
+      out.close();
+   };
+   const auto read = [&]() {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      tracked_storage1 storage;
+      return storage.read_chunked(content, 1000, 2);
+   };
+
+   std::vector<char> data = fc::raw::pack(test_size{ 1, 1 });
+   fc::persistence_util::chunk_table table;
+   table.total_items = 1;
+   table.chunks.push_back({ 0, data.size(), 1, fc::crc32c(data.data(), data.size()) });
+   write(table, data);
+   BOOST_CHECK(read());
+
+   // a chunk larger than the rest of the file is rejected before it is allocated
+   auto huge = table;
+   huge.chunks[0].size = uint64_t(1) << 40;
+   write(huge, data);
+   BOOST_CHECK_THROW(read(), fc::parse_error_exception);
+
+   // more items than bytes
+   auto many = table;
+   many.total_items = many.chunks[0].items = uint64_t(1) << 40;
+   write(many, data);
+   BOOST_CHECK_THROW(read(), fc::parse_error_exception);
+
+   // bytes left over after the listed items
+   std::vector<char> padded = data;
+   padded.push_back(0);
+   auto extra = table;
+   extra.chunks[0].size = padded.size();
+   extra.chunks[0].crc = fc::crc32c(padded.data(), padded.size());
+   write(extra, padded);
+   BOOST_CHECK_THROW(read(), fc::parse_error_exception);
+
+   // a corrupted table fails its crc
+   write(table, data);
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "temp.dat");
+      content.close();
+      content.open(fc::cfile::update_rw_mode);
+      content.seek(4);
+      char c = content.getc();
+      c ^= 0x01;
+      content.seek(4);
+      content.write(&c, 1);
+      content.close();
+   }
+   BOOST_CHECK_THROW(read(), fc::parse_error_exception);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(atomic_write_read_file_storage_test) { try {
+   using tracked_storage1 = fc::tracked_storage<test_size_container>;
+   tracked_storage1 storage1_1;
+   for (uint64_t k = 0; k < 50; ++k)
+      storage1_1.insert(test_size{ k, 1 });
+
+   fc::temp_directory td;
+   auto count_files = [&]() {
+      int n = 0;
+      for (fc::directory_iterator itr(td.path()); itr != fc::directory_iterator(); ++itr)
+         ++n;
+      return n;
+   };
+
+   // discarded without commit
+   {
+      fc::persistence_util::atomic_writer w(td.path(), "a.dat", 0x12345678, 7);
+      storage1_1.write(w.file());
+   }
+   BOOST_CHECK(!fc::exists(td.path() / "a.dat"));
+   BOOST_CHECK_EQUAL(count_files(), 0);
+
+   // the crc is computed while writing, so rewriting content in place is refused
+   {
+      fc::persistence_util::atomic_writer w(td.path(), "a.dat", 0x12345678, 7);
+      w.file().write("abcd", 4);
+      w.file().seek(fc::persistence_util::sealed_header_size);
+      w.file().write("x", 1);
+      BOOST_CHECK_THROW(w.commit(), fc::assert_exception);
+   }
+   BOOST_CHECK(!fc::exists(td.path() / "a.dat"));
+   BOOST_CHECK_EQUAL(count_files(), 0);
+
+   // group commit of two files, one replacing an existing file
+   {
+      auto old = fc::persistence_util::open_cfile_for_write(td.path(), "b.dat");
+      old.write("stale", 5);
+   }
+   {
+      fc::persistence_util::atomic_writer a(td.path(), "a.dat", 0x12345678, 7);
+      fc::persistence_util::atomic_writer b(td.path(), "b.dat", 0x12345678, 7);
+      storage1_1.write(a.file());
+      storage1_1.write_chunked(b.file(), 2, 16);
+      fc::persistence_util::atomic_writer::commit_all({&a, &b});
+   }
+   BOOST_CHECK_EQUAL(count_files(), 2);
+
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "a.dat");
+      BOOST_CHECK_EQUAL(fc::persistence_util::read_sealed_persistence_header(content, 0x12345678, 7, 7, true), 7u);
+      auto ds = content.create_datastream();
+      tracked_storage1 storage1_2;
+      BOOST_CHECK(storage1_2.read(ds, 1000));
+      BOOST_CHECK_EQUAL(storage1_2.index().size(), 50u);
+   }
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "b.dat");
+      BOOST_CHECK_EQUAL(fc::persistence_util::read_sealed_persistence_header(content, 0x12345678, 7, 7, true), 7u);
+      tracked_storage1 storage1_2;
+      BOOST_CHECK(storage1_2.read_chunked(content, 1000));
+      BOOST_CHECK_EQUAL(storage1_2.index().size(), 50u);
+   }
+
+   // a flipped byte is caught by the crc, a truncated file by the size check alone
+   {
+      fc::cfile f;
+      f.set_file_path(td.path() / "a.dat");
+      f.open(fc::cfile::update_rw_mode);
+      f.seek_end(-1);
+      char c = f.getc() ^ 0x01;
+      f.seek_end(-1);
+      f.write(&c, 1);
+   }
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "a.dat");
+      BOOST_CHECK_NO_THROW(fc::persistence_util::read_sealed_persistence_header(content, 0x12345678, 7, 7));
+      BOOST_CHECK_THROW(fc::persistence_util::read_sealed_persistence_header(content, 0x12345678, 7, 7, true), fc::parse_error_exception);
+   }
+   fc::resize_file(td.path() / "b.dat", fc::file_size(td.path() / "b.dat") - 1);
+   {
+      auto content = fc::persistence_util::open_cfile_for_read(td.path(), "b.dat");
+      BOOST_CHECK_THROW(fc::persistence_util::read_sealed_persistence_header(content, 0x12345678, 7, 7), fc::parse_error_exception);
+   }
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE(chunked_benchmark) { try {
+   using tracked_storage2 = fc::tracked_storage<test_size2_container>;
+
+   for (uint64_t num_items : { 10000, 100000 }) { // 1000000, 10000000
+      tracked_storage2 storage;
+      const auto now = fc::time_point::now();
+      for (uint64_t k = 0; k < num_items; ++k)
+         storage.insert(test_size2{ k, now + fc::microseconds(k), 1 });
+
+      fc::temp_directory td;
+      auto timed = [](auto&& f) {
+         auto start = std::chrono::steady_clock::now();
+         f();
+         return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      };
+
+      auto write_ms = timed([&]() {
+         auto out = fc::persistence_util::open_cfile_for_write(td.path(), "serial.dat");
+         storage.write(out);
+         out.flush();
+      });
+      auto chunked_write_ms = timed([&]() {
+         auto out = fc::persistence_util::open_cfile_for_write(td.path(), "chunked.dat");
+         storage.write_chunked(out);
+         out.flush();
+      });
+
+      tracked_storage2 serial_read, chunked_read;
+      auto read_ms = timed([&]() {
+         auto content = fc::persistence_util::open_cfile_for_read(td.path(), "serial.dat");
+         auto ds = content.create_datastream();
+         BOOST_CHECK(serial_read.read(ds, num_items));
+      });
+      auto chunked_read_ms = timed([&]() {
+         auto content = fc::persistence_util::open_cfile_for_read(td.path(), "chunked.dat");
+         BOOST_CHECK(chunked_read.read_chunked(content, num_items));
+      });
+      BOOST_CHECK_EQUAL( serial_read.index().size(), num_items );
+      BOOST_CHECK_EQUAL( chunked_read.index().size(), num_items );
+
+      ilog("${n} items: write ${w} ms, write_chunked ${cw} ms, read ${r} ms, read_chunked ${cr} ms",
+           ("n", num_items)("w", write_ms)("cw", chunked_write_ms)("r", read_ms)("cr", chunked_read_ms));
+   }
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
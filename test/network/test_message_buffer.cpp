@@ -1,4 +1,8 @@
 #include <fc/network/message_buffer.hpp>
+#include <fc/network/ring_message_buffer.hpp>
+#include <fc/network/gather_datastream.hpp>
+
+#include <chrono>
 
 #include <thread>
 
@@ -377,4 +381,220 @@ BOOST_AUTO_TEST_CASE(test_message_buffer) {
    }
 }
 
+/// Ring buffer exposes one contiguous region for reading and writing, including across the wrap point
+BOOST_AUTO_TEST_CASE(ring_message_buffer_wrap)
+{
+  try {
+    constexpr uint32_t cap = 64*1024;
+    fc::ring_message_buffer<cap> mb;
+    BOOST_CHECK_EQUAL(mb.total_bytes(), cap);
+    BOOST_CHECK_EQUAL(mb.bytes_to_write(), cap);
+    BOOST_CHECK_EQUAL(mb.bytes_to_read(), 0u);
+    BOOST_CHECK_EQUAL(mb.read_ptr(), mb.write_ptr());
+
+    {
+      auto mbs = mb.get_buffer_sequence_for_boost_async_read();
+      BOOST_CHECK_EQUAL(mbs.size(), 1u);
+      BOOST_CHECK_EQUAL(mb_size(mbs[0]), cap);
+      BOOST_CHECK_EQUAL(mb_data(mbs[0]), mb.write_ptr());
+    }
+
+    // move the ring close to its end
+    mb.advance_write_ptr(cap - 10);
+    mb.advance_read_ptr(cap - 20);
+    BOOST_CHECK_EQUAL(mb.bytes_to_read(), 10u);
+    BOOST_CHECK_EQUAL(mb.bytes_to_write(), cap - 10);
+
+    // write 100 bytes across the wrap point in one memcpy
+    {
+      auto mbs = mb.get_buffer_sequence_for_boost_async_read();
+      BOOST_CHECK_EQUAL(mb_size(mbs[0]), cap - 10);
+      BOOST_CHECK_EQUAL(mb_data(mbs[0]), mb.write_ptr());
+    }
+    std::vector<char> data(100);
+    for (size_t i = 0; i < data.size(); ++i)
+      data[i] = static_cast<char>(i);
+    memcpy(mb.write_ptr(), data.data(), data.size());
+    mb.advance_write_ptr(data.size());
+
+    mb.advance_read_ptr(10);
+    BOOST_CHECK_EQUAL(mb.bytes_to_read(), 100u);
+    BOOST_CHECK(memcmp(mb.read_ptr(), data.data(), data.size()) == 0);
+
+    std::vector<char> out(100);
+    auto index = mb.read_index();
+    mb.peek(out.data(), 60, index);
+    mb.peek(out.data() + 60, 40, index);
+    BOOST_CHECK(out == data);
+    BOOST_CHECK_THROW(mb.peek(out.data(), 1, index), fc::out_of_range_exception);
+
+    BOOST_CHECK_THROW(mb.advance_write_ptr(cap), fc::out_of_range_exception);
+    BOOST_CHECK_THROW(mb.add_space(cap - 99), fc::out_of_range_exception);
+    BOOST_CHECK_NO_THROW(mb.add_space(cap - 100));
+
+    std::fill(out.begin(), out.end(), 0);
+    mb.read(out.data(), out.size());
+    BOOST_CHECK(out == data);
+    BOOST_CHECK_EQUAL(mb.bytes_to_read(), 0u);
+    BOOST_CHECK_THROW(mb.read(out.data(), 1), fc::out_of_range_exception);
+  }
+  FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE(ring_message_buffer_datastream) {
+   fc::ring_message_buffer<4096> mbuff;
+
+   // straddle the wrap point
+   mbuff.advance_write_ptr(4090);
+   mbuff.advance_read_ptr(4089);
+
+   char buf[64];
+   fc::datastream<char*> ds( buf, sizeof(buf) );
+   fc::raw::pack( ds, 13 );
+   fc::raw::pack( ds, 42 );
+   fc::raw::pack( ds, std::string( "hello" ) );
+   const size_t packed = ds.tellp();
+
+   memcpy(mbuff.write_ptr(), buf, packed);
+   mbuff.advance_write_ptr(packed);
+   mbuff.advance_read_ptr(1);
+
+   int v = 0;
+   std::string s;
+   for( int i = 0; i < 3; ++i ) {
+      auto ds2 = mbuff.create_peek_datastream();
+      fc::raw::unpack( ds2, v );
+      BOOST_CHECK_EQUAL( 13, v );
+      fc::raw::unpack( ds2, v );
+      BOOST_CHECK_EQUAL( 42, v );
+      fc::raw::unpack( ds2, s );
+      BOOST_CHECK_EQUAL( s, std::string( "hello" ) );
+      BOOST_CHECK_EQUAL( ds2.tellp(), packed );
+   }
+
+   auto ds2 = mbuff.create_datastream();
+   fc::raw::unpack( ds2, v );
+   BOOST_CHECK_EQUAL( 13, v );
+   fc::raw::unpack( ds2, v );
+   BOOST_CHECK_EQUAL( 42, v );
+   fc::raw::unpack( ds2, s );
+   BOOST_CHECK_EQUAL( s, std::string( "hello" ) );
+   BOOST_CHECK_EQUAL( mbuff.bytes_to_read(), 0u );
+   BOOST_CHECK_THROW( fc::raw::unpack( ds2, v ), fc::out_of_range_exception );
+}
+
+BOOST_AUTO_TEST_CASE(message_buffer_write_datastream) {
+   using my_message_buffer_t = fc::message_buffer<1024>;
+   my_message_buffer_t mbuff;
+   mbuff.advance_write_ptr(1000);
+   mbuff.advance_read_ptr(1000);
+
+   const std::string big(3000, 'x');
+   auto ds = mbuff.create_write_datastream();
+   fc::raw::pack( ds, 13 );
+   fc::raw::pack( ds, big );
+   fc::raw::pack( ds, std::string( "hello" ) );
+   BOOST_CHECK_EQUAL( ds.tellp(), fc::raw::pack_size( 13 ) + fc::raw::pack_size( big ) + fc::raw::pack_size( std::string( "hello" ) ) );
+   BOOST_CHECK_EQUAL( mbuff.bytes_to_read(), ds.tellp() );
+
+   auto ds2 = mbuff.create_datastream();
+   int v = 0;
+   std::string s;
+   fc::raw::unpack( ds2, v );
+   BOOST_CHECK_EQUAL( 13, v );
+   fc::raw::unpack( ds2, s );
+   BOOST_CHECK( s == big );
+   fc::raw::unpack( ds2, s );
+   BOOST_CHECK_EQUAL( s, std::string( "hello" ) );
+   BOOST_CHECK_EQUAL( mbuff.bytes_to_read(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE(gather_datastream_shared_payload) {
+   const std::vector<char> block(100000, 'b');
+   const auto payload = fc::shared_payload::pack( block );
+   BOOST_CHECK_EQUAL( payload.size(), fc::raw::pack_size( block ) );
+
+   auto flatten = [](const fc::gather_datastream& ds) {
+      std::vector<char> out(ds.tellp());
+      BOOST_CHECK_EQUAL( boost::asio::buffer_copy( boost::asio::buffer(out), ds.buffers() ), out.size() );
+      return out;
+   };
+
+   // header, referenced payload, trailer for each of several peers
+   std::vector<fc::gather_datastream> peers(3);
+   for (auto& ds : peers) {
+      fc::raw::pack( ds, uint32_t(payload.size()) );
+      fc::raw::pack( ds, std::string( "block" ) );
+      ds.append( payload );
+      fc::raw::pack( ds, std::string( 5000, 't' ) );
+      fc::raw::pack( ds, uint8_t(1) );
+   }
+   BOOST_CHECK_EQUAL( payload.use_count(), 4 );
+
+   std::vector<char> expected = fc::raw::pack( uint32_t(payload.size()) );
+   for (const auto& part : { fc::raw::pack( std::string( "block" ) ), fc::raw::pack( block ),
+                             fc::raw::pack( std::string( 5000, 't' ) ), fc::raw::pack( uint8_t(1) ) })
+      expected.insert( expected.end(), part.begin(), part.end() );
+
+   for (const auto& ds : peers) {
+      BOOST_CHECK_EQUAL( ds.tellp(), expected.size() );
+      BOOST_CHECK( flatten( ds ) == expected );
+      // the payload is referenced, not copied; small writes before it are coalesced:
+      // header | payload | trailer length | trailer data (larger than a chunk) | uint8
+      BOOST_REQUIRE_EQUAL( ds.buffers().size(), 5u );
+      BOOST_CHECK_EQUAL( ds.buffers()[1].data(), payload.data() );
+   }
+
+   peers.clear();
+   BOOST_CHECK_EQUAL( payload.use_count(), 1 );
+}
+
+/// Compare the chunked message_buffer with the ring for a stream of small messages
+BOOST_AUTO_TEST_CASE(message_buffer_benchmark) {
+   constexpr uint32_t buffer_size = 1024*1024;
+   constexpr size_t num_messages = 100000; // 10000000
+   constexpr size_t message_size = 300;
+
+   std::vector<char> message(message_size);
+   {
+      fc::datastream<char*> ds(message.data(), message.size());
+      fc::raw::pack(ds, std::string(message_size - 2, 'm'));
+   }
+
+   auto run = [&](auto& mb, auto&& unpack_one) {
+      auto start = std::chrono::steady_clock::now();
+      size_t total = 0;
+      for (size_t i = 0; i < num_messages; ++i) {
+         if (mb.bytes_to_write() < message_size)
+            mb.add_space(message_size);
+         auto seq = mb.get_buffer_sequence_for_boost_async_read();
+         boost::asio::buffer_copy(seq, boost::asio::buffer(message));
+         mb.advance_write_ptr(message_size);
+         total += unpack_one(mb);
+      }
+      BOOST_CHECK_EQUAL(total, num_messages * (message_size - 2));
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / num_messages;
+   };
+
+   fc::message_buffer<buffer_size> chunked;
+   auto chunked_ns = run(chunked, [](auto& mb) {
+      auto ds = mb.create_datastream();
+      std::string s;
+      fc::raw::unpack(ds, s);
+      return s.size();
+   });
+
+   fc::ring_message_buffer<buffer_size> ring;
+   auto ring_ns = run(ring, [](auto& mb) {
+      auto ds = mb.create_peek_datastream();
+      std::string s;
+      fc::raw::unpack(ds, s);
+      mb.advance_read_ptr(ds.tellp());
+      return s.size();
+   });
+
+   ilog("${n} byte messages: message_buffer ${c} ns/message, ring_message_buffer ${r} ns/message",
+        ("n", message_size)("c", chunked_ns)("r", ring_ns));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,37 @@
 #include <fc/exception/exception.hpp>
 #include <fc/static_variant.hpp>
 #include <fc/variant.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/time.hpp>
+
+namespace static_variant_test {
+   // 30 distinct alternatives of 1 to 30 bytes
+   template<std::size_t... I>
+   std::variant<std::array<uint8_t, I + 1>...> make_wide_variant( std::index_sequence<I...> );
+   using wide_variant = decltype( make_wide_variant( std::make_index_sequence<30>{} ) );
+
+   template<std::size_t I>
+   wide_variant make_alternative() {
+      std::array<uint8_t, I + 1> a;
+      a.fill( uint8_t(I) );
+      return wide_variant{ std::in_place_index<I>, a };
+   }
+
+   template<typename Variant>
+   void unpack_benchmark( const char* name, const Variant& value, size_t loops ) {
+      const auto packed = fc::raw::pack( value );
+      Variant v;
+      auto start = fc::time_point::now();
+      for( size_t i = 0; i < loops; ++i ) {
+         fc::datastream<const char*> ds( packed.data(), packed.size() );
+         fc::raw::unpack( ds, v );
+      }
+      auto elapsed = fc::time_point::now() - start;
+      BOOST_CHECK( v == value );
+      ilog( "${n}: ${l} unpacks of alternative ${i} in ${t} us", ("n", name)("l", loops)("i", value.index())("t", elapsed.count()) );
+   }
+}
+using namespace static_variant_test;
 
 BOOST_AUTO_TEST_SUITE(static_variant_test_suite)
    BOOST_AUTO_TEST_CASE(to_from_fc_variant)
@@ -53,4 +84,41 @@ BOOST_AUTO_TEST_SUITE(static_variant_test_suite)
       BOOST_REQUIRE((fc::get_index<variant_type, std::string>() == 2));
       BOOST_REQUIRE((fc::get_index<variant_type, double>() == std::variant_size_v<variant_type>)); // Isn't a type contained in variant.
    }
+
+   BOOST_AUTO_TEST_CASE(raw_unpack_replaces_alternative)
+   {
+      using variant_type = std::variant<int32_t, bool, std::string>;
+      variant_type v{ std::string( 100, 'x' ) };
+      const auto packed = fc::raw::pack( variant_type{ int32_t(7) } );
+      v = fc::raw::unpack<variant_type>( packed );
+      BOOST_REQUIRE( std::get<int32_t>(v) == 7 );
+
+      auto bad = packed;
+      bad[0] = 3;
+      BOOST_CHECK_EXCEPTION( fc::raw::unpack<variant_type>( bad ), fc::assert_exception, [](const auto& e) { return e.code() == fc::assert_exception_code; } );
+
+      const wide_variant w = make_alternative<29>();
+      wide_variant w2;
+      w2 = fc::raw::unpack<wide_variant>( fc::raw::pack( w ) );
+      BOOST_REQUIRE( w2 == w );
+
+      fc::variant fv;
+      fc::to_variant( w, fv );
+      wide_variant w3 = make_alternative<3>();
+      fc::from_variant( fv, w3 );
+      BOOST_REQUIRE( w3 == w );
+
+      fc::from_index( w3, 17 );
+      BOOST_REQUIRE( w3.index() == 17 );
+   }
+
+   BOOST_AUTO_TEST_CASE(unpack_benchmark)
+   {
+      using small_variant = std::variant<int32_t, bool, std::array<uint8_t, 8>>;
+      const size_t loops = 1000; // 10000000
+      static_variant_test::unpack_benchmark( "3 alternatives", small_variant{ int32_t(7) }, loops );
+      static_variant_test::unpack_benchmark( "3 alternatives", small_variant{ std::array<uint8_t, 8>{} }, loops );
+      static_variant_test::unpack_benchmark( "30 alternatives", make_alternative<0>(), loops );
+      static_variant_test::unpack_benchmark( "30 alternatives", make_alternative<29>(), loops );
+   }
 BOOST_AUTO_TEST_SUITE_END()
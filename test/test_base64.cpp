@@ -37,6 +37,25 @@ BOOST_AUTO_TEST_CASE(base64urldec) try {
    BOOST_CHECK_EQUAL(expected_output, base64url_decode(input));
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(base64urldec_buffer) try {
+   auto input = "YWJjMTIzJCYoKSc_tPUB-n5h"s;
+   auto expected_output = "abc123$&()'?\xb4\xf5\x01\xfa~a"s;
+
+   char buf[32];
+   BOOST_REQUIRE_EQUAL(expected_output.size(), base64url_decode(input.data(), input.size(), buf, sizeof(buf)));
+   BOOST_CHECK_EQUAL(expected_output, std::string(buf, expected_output.size()));
+
+   // output is truncated to the buffer but the full decoded size is reported
+   char small[4] = {};
+   BOOST_CHECK_EQUAL(expected_output.size(), base64url_decode(input.data(), input.size(), small, sizeof(small)));
+   BOOST_CHECK_EQUAL(expected_output.substr(0, 4), std::string(small, 4));
+
+   auto bad = "YWJjMTIz$"s;
+   BOOST_CHECK_EXCEPTION(base64url_decode(bad.data(), bad.size(), buf, sizeof(buf)), fc::exception, [](const fc::exception& e) {
+      return e.to_detail_string().find("encountered non-base64 character") != std::string::npos;
+   });
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_CASE(base64dec_extraequals) try {
    auto input = "YWJjMTIzJCYoKSc/tPUB+n5h========="s;
    auto expected_output = "abc123$&()'?\xb4\xf5\x01\xfa~a"s;
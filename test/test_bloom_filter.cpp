@@ -0,0 +1,135 @@
+#define BOOST_TEST_MODULE bloom_filter
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/bloom_filter.hpp>
+#include <fc/io/raw.hpp>
+#include <fc/exception/exception.hpp>
+
+using namespace fc;
+
+namespace {
+
+bloom_parameters make_parameters(unsigned long long int count, double fpp) {
+   bloom_parameters p;
+   p.projected_element_count    = count;
+   p.false_positive_probability = fpp;
+   p.compute_optimal_parameters();
+   return p;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(bloom_filter_tests)
+
+BOOST_AUTO_TEST_CASE(blocked_insert_contains) try {
+   blocked_bloom_filter f(make_parameters(10000, 0.01));
+   BOOST_REQUIRE(!!f);
+   BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(f.table()) % blocked_bloom_filter::block_bytes, 0u);
+   BOOST_CHECK_EQUAL(f.size() % blocked_bloom_filter::bits_per_block, 0u);
+
+   for (uint64_t i = 0; i < 10000; ++i)
+      f.insert(i);
+   f.insert(std::string("hello"));
+   BOOST_CHECK_EQUAL(f.element_count(), 10001u);
+
+   for (uint64_t i = 0; i < 10000; ++i)
+      BOOST_REQUIRE(f.contains(i));
+   BOOST_CHECK(f.contains(std::string("hello")));
+
+   // blocking costs some accuracy, but should stay within a small factor of the requested rate
+   unsigned int false_positives = 0;
+   for (uint64_t i = 10000; i < 110000; ++i)
+      false_positives += f.contains(i);
+   BOOST_CHECK_LT(false_positives, 100000 * 0.01 * 3);
+
+   f.clear();
+   BOOST_CHECK_EQUAL(f.element_count(), 0u);
+   BOOST_CHECK(!f.contains(uint64_t(1)));
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(blocked_batch_matches_single) try {
+   blocked_bloom_filter single(make_parameters(5000, 0.001));
+   blocked_bloom_filter batch(make_parameters(5000, 0.001));
+
+   std::vector<std::string> keys;
+   for (int i = 0; i < 5000; ++i)
+      keys.push_back("key" + std::to_string(i));
+
+   for (const auto& k : keys)
+      single.insert(k);
+   batch.insert_many(keys.begin(), keys.end());
+   BOOST_CHECK(single == batch);
+
+   std::vector<std::string> probes;
+   for (int i = 0; i < 10000; ++i)
+      probes.push_back("key" + std::to_string(i));
+
+   std::vector<bool> results;
+   batch.contains_many(probes.begin(), probes.end(), std::back_inserter(results));
+   BOOST_REQUIRE_EQUAL(results.size(), probes.size());
+   for (std::size_t i = 0; i < probes.size(); ++i)
+      BOOST_REQUIRE_EQUAL(results[i], single.contains(probes[i]));
+   for (std::size_t i = 0; i < keys.size(); ++i)
+      BOOST_REQUIRE(results[i]);
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(blocked_raw_round_trip) try {
+   blocked_bloom_filter f(make_parameters(1000, 0.01));
+   for (uint32_t i = 0; i < 1000; ++i)
+      f.insert(i);
+
+   auto packed = fc::raw::pack(f);
+   blocked_bloom_filter unpacked = fc::raw::unpack<blocked_bloom_filter>(packed);
+   BOOST_CHECK(f == unpacked);
+   BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(unpacked.table()) % blocked_bloom_filter::block_bytes, 0u);
+   for (uint32_t i = 0; i < 1000; ++i)
+      BOOST_REQUIRE(unpacked.contains(i));
+
+   // table is packed like a std::vector<uint64_t>
+   fc::datastream<const char*> ds(packed.data(), packed.size());
+   unsigned int salt_count; unsigned long long int block_count, projected; unsigned int inserted;
+   unsigned long long int seed; double fpp; std::vector<uint64_t> table;
+   fc::raw::unpack(ds, salt_count);
+   fc::raw::unpack(ds, block_count);
+   fc::raw::unpack(ds, projected);
+   fc::raw::unpack(ds, inserted);
+   fc::raw::unpack(ds, seed);
+   fc::raw::unpack(ds, fpp);
+   fc::raw::unpack(ds, table);
+   BOOST_CHECK_EQUAL(ds.remaining(), 0u);
+   BOOST_CHECK(std::equal(table.begin(), table.end(), f.bit_table_.begin(), f.bit_table_.end()));
+
+   // a table that does not match the block count is rejected
+   packed.back() = 0;
+   packed[packed.size() - f.bit_table_.size() * sizeof(uint64_t) - 1] ^= 1;
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(packed), fc::assert_exception);
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(blocked_unpack_rejects_bad_parameters) try {
+   blocked_bloom_filter f(make_parameters(1000, 0.01));
+   f.insert(uint32_t(1));
+
+   const auto with = [&](unsigned int salt_count, unsigned long long int block_count) {
+      blocked_bloom_filter g = f;
+      g.salt_count_ = salt_count;
+      g.block_count_ = block_count;
+      return fc::raw::pack(g);
+   };
+   BOOST_CHECK_NO_THROW(fc::raw::unpack<blocked_bloom_filter>(with(f.salt_count_, f.block_count_)));
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(with(0, f.block_count_)), fc::assert_exception);
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(with(f.salt_count_, 0)), fc::assert_exception);
+   // rejected before the table is allocated
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(with(f.salt_count_, blocked_bloom_filter::max_unpack_block_count + 1)),
+                     fc::assert_exception);
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(with(f.salt_count_, std::numeric_limits<uint32_t>::max())),
+                     fc::assert_exception);
+
+   // a default constructed filter has no table
+   blocked_bloom_filter empty;
+   BOOST_CHECK(!empty);
+   BOOST_CHECK(!empty.contains(uint32_t(1)));
+   BOOST_CHECK_THROW(empty.insert(uint32_t(1)), fc::assert_exception);
+   BOOST_CHECK_THROW(fc::raw::unpack<blocked_bloom_filter>(fc::raw::pack(empty)), fc::assert_exception);
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
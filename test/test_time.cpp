@@ -0,0 +1,174 @@
+#define BOOST_TEST_MODULE time
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/time.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <random>
+
+using namespace fc;
+
+namespace {
+   // the boost::posix_time conversions that time_point and time_point_sec used before, as a reference
+   namespace boost_reference {
+      std::string to_iso_string( const time_point_sec& t ) {
+         return boost::posix_time::to_iso_extended_string( boost::posix_time::from_time_t( time_t( t.sec_since_epoch() ) ) );
+      }
+
+      std::string to_non_delimited_iso_string( const time_point_sec& t ) {
+         return boost::posix_time::to_iso_string( boost::posix_time::from_time_t( time_t( t.sec_since_epoch() ) ) );
+      }
+
+      std::string to_string( const time_point& t ) {
+         auto count = t.time_since_epoch().count();
+         if( count >= 0 ) {
+            uint64_t secs = (uint64_t)count / 1000000ULL;
+            uint64_t msec = ((uint64_t)count % 1000000ULL) / 1000ULL;
+            std::string padded_ms = fc::to_string( (uint64_t)(msec + 1000ULL) ).substr( 1 );
+            return boost::posix_time::to_iso_extended_string( boost::posix_time::from_time_t( time_t( secs ) ) ) + "." + padded_ms;
+         }
+         return boost::posix_time::to_iso_string( boost::posix_time::microseconds( count ) );
+      }
+
+      time_point_sec sec_from_iso_string( const std::string& s ) {
+         static boost::posix_time::ptime epoch = boost::posix_time::from_time_t( 0 );
+         boost::posix_time::ptime pt;
+         if( s.size() >= 5 && s.at( 4 ) == '-' )
+            pt = boost::date_time::parse_delimited_time<boost::posix_time::ptime>( s, 'T' );
+         else
+            pt = boost::posix_time::from_iso_string( s );
+         return time_point_sec( (pt - epoch).total_seconds() );
+      }
+
+      time_point from_iso_string( const std::string& s ) {
+         auto dot = s.find( '.' );
+         if( dot == std::string::npos )
+            return time_point( sec_from_iso_string( s ) );
+         auto ms = s.substr( dot );
+         ms[0] = '1';
+         while( ms.size() < 4 ) ms.push_back( '0' );
+         return time_point( sec_from_iso_string( s ) ) + milliseconds( to_int64( ms ) - 1000 );
+      }
+   }
+
+   /// runs both parsers, true if they agree on the result or both reject s
+   template<typename T, typename Parse, typename Reference>
+   bool same_parse( const std::string& s, Parse&& parse, Reference&& reference ) {
+      std::optional<T> fast, ref;
+      try { fast = parse( s ); } catch( ... ) {}
+      try { ref = reference( s ); } catch( ... ) {}
+      return fast == ref;
+   }
+
+   const int64_t year_10000 = 253402300800ll; // 10000-01-01T00:00:00
+}
+
+BOOST_AUTO_TEST_SUITE(time_test_suite)
+
+BOOST_AUTO_TEST_CASE(iso_strings) try {
+   BOOST_CHECK_EQUAL( std::string( time_point_sec() ), "1970-01-01T00:00:00" );
+   BOOST_CHECK_EQUAL( std::string( time_point_sec::maximum() ), "2106-02-07T06:28:15" );
+   BOOST_CHECK_EQUAL( time_point_sec( 951782400 ).to_non_delimited_iso_string(), "20000229T000000" );
+   BOOST_CHECK_EQUAL( std::string( time_point( seconds( 951782400 ) + milliseconds( 7 ) + microseconds( 999 ) ) ), "2000-02-29T00:00:00.007" );
+
+   char buf[32];
+   BOOST_CHECK_EQUAL( time_point( seconds( 1 ) ).to_iso_string( buf ), 23u );
+   BOOST_CHECK_EQUAL( std::string( buf ), "1970-01-01T00:00:01.000" );
+   BOOST_CHECK_EQUAL( time_point( microseconds( -1500 ) ).to_iso_string( buf ), 14u );
+   BOOST_CHECK_EQUAL( std::string( buf ), "-000000.001500" );
+
+   BOOST_CHECK( time_point::from_iso_string( "2000-02-29T00:00:00.007" ) == time_point( seconds( 951782400 ) + milliseconds( 7 ) ) );
+   BOOST_CHECK( time_point::from_iso_string( "2000-02-29T00:00:00.5" ) == time_point( seconds( 951782400 ) + milliseconds( 500 ) ) );
+   BOOST_CHECK( time_point_sec::from_iso_string( "20000229T000000" ) == time_point_sec( 951782400 ) );
+   BOOST_CHECK_THROW( time_point_sec::from_iso_string( "2001-02-29T00:00:00" ), fc::exception );
+   BOOST_CHECK_THROW( time_point_sec::from_iso_string( "2001-02-2xT00:00:00" ), fc::exception );
+   BOOST_CHECK_THROW( time_point::from_iso_string( "2001-02-28T00:00:00.1x3" ), fc::exception );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(matches_boost) try {
+   std::mt19937_64 rng( 3 );
+   const char replacements[] = "0123456789-:T.Z x";
+   for( size_t i = 0; i < 20000; ++i ) {
+      const time_point_sec sec{ uint32_t( rng() ) };
+      BOOST_REQUIRE_EQUAL( std::string( sec ), boost_reference::to_iso_string( sec ) );
+      BOOST_REQUIRE_EQUAL( sec.to_non_delimited_iso_string(), boost_reference::to_non_delimited_iso_string( sec ) );
+
+      const time_point tp( microseconds( int64_t( rng() % uint64_t( year_10000 * 1000000 ) ) ) );
+      const std::string s = std::string( tp );
+      BOOST_REQUIRE_EQUAL( s, boost_reference::to_string( tp ) );
+      BOOST_REQUIRE( time_point::from_iso_string( s ) == boost_reference::from_iso_string( s ) );
+
+      // mutate a character or shorten the fraction; both parsers must agree, including on rejecting it
+      std::string m = s;
+      if( rng() % 4 == 0 )
+         m.resize( m.size() - 1 - rng() % 3 );
+      else
+         m[rng() % m.size()] = replacements[rng() % (sizeof(replacements) - 1)];
+      BOOST_REQUIRE_MESSAGE( (same_parse<time_point>( m, &time_point::from_iso_string, &boost_reference::from_iso_string )), m );
+
+      std::string ms = std::string( sec );
+      if( rng() % 2 )
+         ms = sec.to_non_delimited_iso_string();
+      ms[rng() % ms.size()] = replacements[rng() % (sizeof(replacements) - 1)];
+      BOOST_REQUIRE_MESSAGE( (same_parse<time_point_sec>( ms, &time_point_sec::from_iso_string, &boost_reference::sec_from_iso_string )), ms );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(iso_string_benchmark) try {
+   const size_t loops = 1000; // 1000000
+   const time_point tp = time_point::from_iso_string( "2024-05-17T12:34:56.789" );
+   const std::string s = std::string( tp );
+
+   size_t total = 0;
+   auto start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += std::string( tp + milliseconds( i ) ).size();
+   auto format = time_point::now() - start;
+
+   start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += boost_reference::to_string( tp + milliseconds( i ) ).size();
+   auto boost_format = time_point::now() - start;
+
+   start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += time_point::from_iso_string( s ).time_since_epoch().count() & 1;
+   auto parse = time_point::now() - start;
+
+   start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += boost_reference::from_iso_string( s ).time_since_epoch().count() & 1;
+   auto boost_parse = time_point::now() - start;
+
+   BOOST_CHECK( total > 0 );
+   ilog( "${n} time_point to string: ${f} us, boost ${bf} us; from_iso_string: ${p} us, boost ${bp} us",
+         ("n", loops)("f", format.count())("bf", boost_format.count())("p", parse.count())("bp", boost_parse.count()) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(coarse_clock) try {
+   for( size_t i = 0; i < 100; ++i ) {
+      const time_point coarse = time_point::now_coarse();
+      const time_point precise = time_point::now();
+      BOOST_CHECK( coarse <= precise );
+      BOOST_CHECK( precise - coarse < milliseconds( 50 ) );
+   }
+
+   const size_t loops = 1000; // 10000000
+   int64_t total = 0;
+   auto start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += time_point::now().time_since_epoch().count() & 1;
+   auto precise = time_point::now() - start;
+
+   start = time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      total += time_point::now_coarse().time_since_epoch().count() & 1;
+   auto coarse = time_point::now() - start;
+
+   ilog( "${n} calls: now ${p} us, now_coarse ${c} us", ("n", loops)("p", precise.count())("c", coarse.count())("t", total) );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
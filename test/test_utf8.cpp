@@ -0,0 +1,154 @@
+#define BOOST_TEST_MODULE utf8
+#include <boost/test/included/unit_test.hpp>
+
+#include <fc/utf8.hpp>
+#include <fc/exception/exception.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/time.hpp>
+
+#include <random>
+
+using namespace fc;
+using namespace std::literals;
+
+namespace {
+   void append_code_point( std::string& s, uint32_t cp ) {
+      if( cp < 0x80 ) {
+         s += char(cp);
+      } else if( cp < 0x800 ) {
+         s += char(0xC0 | (cp >> 6));
+         s += char(0x80 | (cp & 0x3F));
+      } else if( cp < 0x10000 ) {
+         s += char(0xE0 | (cp >> 12));
+         s += char(0x80 | ((cp >> 6) & 0x3F));
+         s += char(0x80 | (cp & 0x3F));
+      } else {
+         s += char(0xF0 | (cp >> 18));
+         s += char(0x80 | ((cp >> 12) & 0x3F));
+         s += char(0x80 | ((cp >> 6) & 0x3F));
+         s += char(0x80 | (cp & 0x3F));
+      }
+   }
+
+   /// mostly valid text with runs of ASCII, multibyte code points and the occasional C1 control or stray byte
+   std::string random_text( std::mt19937& rng, size_t pieces, bool allow_invalid ) {
+      std::string s;
+      for( size_t i = 0; i < pieces; ++i ) {
+         switch( rng() % (allow_invalid ? 8 : 5) ) {
+            case 0: s.append( rng() % 40, char('a' + rng() % 26) ); break;
+            case 1: append_code_point( s, 0xA0 + rng() % (0x800 - 0xA0) ); break;
+            case 2: {
+               uint32_t cp = 0x800 + rng() % (0x10000 - 0x800);
+               append_code_point( s, cp >= 0xD800 && cp <= 0xDFFF ? cp - 0x800 : cp );
+               break;
+            }
+            case 3: append_code_point( s, 0x10000 + rng() % (0x110000 - 0x10000) ); break;
+            case 4: s += char(rng() % 0x80); break;
+            case 5: append_code_point( s, 0x80 + rng() % 0x20 ); break; // C1 control
+            case 6: s += char(0x80 + rng() % 0x80); break;
+            case 7: { // truncated sequence
+               std::string cp;
+               append_code_point( cp, 0x80 + rng() % 0x10FF80 );
+               s += cp.substr( 0, 1 + rng() % (cp.size() - 1) );
+               break;
+            }
+         }
+      }
+      return s;
+   }
+
+   bool reference_is_utf8( const std::string& s ) {
+      std::wstring w;
+      try {
+         decodeUtf8( s, &w );
+         return true;
+      } catch( ... ) {
+         return false;
+      }
+   }
+}
+
+BOOST_AUTO_TEST_SUITE(utf8_test_suite)
+
+BOOST_AUTO_TEST_CASE(valid_utf8) try {
+   BOOST_CHECK( is_valid_utf8( "" ) );
+   BOOST_CHECK( is_valid_utf8( "plain ascii" ) );
+   BOOST_CHECK( is_valid_utf8( "\xc2\xa0 \xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80" ) );
+   BOOST_CHECK( is_valid_utf8( "\xed\x9f\xbf \xee\x80\x80 \xf4\x8f\xbf\xbf" ) ); // around the surrogates, max code point
+
+   BOOST_CHECK( !is_valid_utf8( "\xc2\x80" ) );         // C1 control
+   BOOST_CHECK( !is_valid_utf8( "\xc2\x9f" ) );
+   BOOST_CHECK( !is_valid_utf8( "\x80" ) );             // stray continuation
+   BOOST_CHECK( !is_valid_utf8( "\xc3" ) );             // truncated
+   BOOST_CHECK( !is_valid_utf8( "\xe2\x82" ) );
+   BOOST_CHECK( !is_valid_utf8( "\xc0\xaf" ) );         // overlong
+   BOOST_CHECK( !is_valid_utf8( "\xe0\x80\xaf" ) );
+   BOOST_CHECK( !is_valid_utf8( "\xf0\x80\x80\xaf" ) );
+   BOOST_CHECK( !is_valid_utf8( "\xed\xa0\x80" ) );     // surrogate
+   BOOST_CHECK( !is_valid_utf8( "\xf4\x90\x80\x80" ) ); // > 0x10FFFF
+   BOOST_CHECK( !is_valid_utf8( "\xf8\x88\x80\x80\x80" ) );
+
+   BOOST_CHECK( is_utf8( "\xc2\x80"s ) );
+   BOOST_CHECK( !is_utf8( "\xed\xa0\x80"s ) );
+
+   // sequences split across 16 and 32 byte blocks, and cut short at the end
+   for( size_t offset = 0; offset < 40; ++offset ) {
+      const std::string pad( offset, 'x' );
+      BOOST_CHECK( is_valid_utf8( pad + "\xf0\x9f\x98\x80" + pad ) );
+      BOOST_CHECK( is_valid_utf8( pad + "\xe2\x82\xac" ) );
+      BOOST_CHECK( !is_valid_utf8( pad + "\xf0\x9f\x98" ) );
+      BOOST_CHECK( !is_valid_utf8( pad + "\xc2\x85" + pad ) );
+      BOOST_CHECK( !is_valid_utf8( pad + "\xe2\x82" + std::string( 64, 'y' ) ) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(matches_reference) try {
+   std::mt19937 rng( 7 );
+   for( size_t i = 0; i < 5000; ++i ) {
+      const std::string s = random_text( rng, 1 + rng() % 24, i % 2 );
+      const bool valid = prune_invalid_utf8( s ) == s;
+      BOOST_CHECK_MESSAGE( is_valid_utf8( s ) == valid, "is_valid_utf8 differs for " << fc::to_hex( s.data(), s.size() ) );
+      BOOST_CHECK_MESSAGE( is_utf8( s ) == reference_is_utf8( s ), "is_utf8 differs for " << fc::to_hex( s.data(), s.size() ) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(prune) try {
+   BOOST_CHECK_EQUAL( prune_invalid_utf8( "a\xc2\x85z" ), "a\\u0085z" );
+   BOOST_CHECK_EQUAL( prune_invalid_utf8( "a\x80z\xe2\x82\xac" ), "az\xe2\x82\xac" );
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(validation_benchmark) try {
+   std::mt19937 rng( 11 );
+   std::string multibyte;
+   while( multibyte.size() < 64*1024 ) {
+      const uint32_t cp = 0xA0 + rng() % 0xFF00;
+      if( cp < 0xD800 || cp > 0xDFFF )
+         append_code_point( multibyte, cp );
+   }
+   std::string mixed;
+   while( mixed.size() < 64*1024 )
+      mixed += random_text( rng, 16, false );
+   const std::pair<const char*, std::string> corpora[] = {
+      { "ascii", std::string( 64*1024, 'a' ) }, { "mixed", mixed }, { "multibyte", multibyte }
+   };
+
+   const size_t loops = 10; // 1000
+   for( const auto& [name, text] : corpora ) {
+      bool valid = true;
+      auto start = fc::time_point::now();
+      for( size_t i = 0; i < loops; ++i )
+         valid &= is_valid_utf8( text );
+      auto validate = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      for( size_t i = 0; i < loops; ++i )
+         valid &= prune_invalid_utf8( text ).size() == text.size();
+      auto prune = fc::time_point::now() - start;
+
+      BOOST_CHECK( valid );
+      ilog( "${n} ${s} bytes: is_valid_utf8 ${v} us, prune_invalid_utf8 ${p} us",
+            ("n", name)("s", text.size() * loops)("v", validate.count())("p", prune.count()) );
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,7 +4,89 @@
 #include <fc/variant_object.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/time.hpp>
+#include <fc/io/json.hpp>
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <utility>
+
+namespace variant_test {
+   struct action {
+      std::string       account;
+      std::string       name;
+      std::vector<char> data;
+   };
+
+   struct transaction {
+      fc::time_point_sec  expiration;
+      uint32_t            ref_block_num = 0;
+      std::vector<action> actions;
+   };
+
+   struct block {
+      fc::time_point           timestamp;
+      std::string              producer;
+      std::vector<transaction> transactions;
+   };
+
+   block make_block( size_t num_transactions ) {
+      block b{ fc::time_point::now(), "producer.one" };
+      for( size_t i = 0; i < num_transactions; ++i ) {
+         transaction t{ fc::time_point_sec( 1000 + i ), static_cast<uint32_t>( i ) };
+         for( size_t j = 0; j < 3; ++j )
+            t.actions.push_back( action{ "account." + std::to_string( j ), "transfer", std::vector<char>( 64, char( i ) ) } );
+         b.transactions.push_back( std::move( t ) );
+      }
+      return b;
+   }
+}
+
+namespace variant_test {
+   struct base {
+      uint32_t    id = 0;
+      std::string name;
+   };
+
+   struct long_names {
+      uint64_t first_long_member_name  = 1;
+      uint64_t second_long_member_name = 2;
+      uint64_t third_long_member_name  = 3;
+      uint64_t fourth_long_member_name = 4;
+   };
+
+   /// reflected, but converted from "id:<n>" strings by its own from_variant
+   struct custom_id {
+      uint64_t value = 0;
+   };
+
+   void from_variant( const fc::variant& v, custom_id& id ) {
+      const std::string& s = v.get_string();
+      FC_ASSERT( s.rfind( "id:", 0 ) == 0, "not an id: ${s}", ("s", s) );
+      id.value = std::stoull( s.substr( 3 ) );
+   }
+
+   struct with_ids {
+      custom_id              id;
+      std::vector<custom_id> more;
+   };
+
+   struct derived : base {
+      std::string name; // hides base::name
+      uint32_t    extra = 0;
+   };
+}
+
+FC_REFLECT( variant_test::action, (account)(name)(data) )
+FC_REFLECT( variant_test::transaction, (expiration)(ref_block_num)(actions) )
+FC_REFLECT( variant_test::block, (timestamp)(producer)(transactions) )
+FC_REFLECT( variant_test::base, (id)(name) )
+FC_REFLECT( variant_test::custom_id, (value) )
+FC_REFLECT( variant_test::with_ids, (id)(more) )
+FC_REFLECT( variant_test::long_names, (first_long_member_name)(second_long_member_name)(third_long_member_name)(fourth_long_member_name) )
+FC_REFLECT_DERIVED( variant_test::derived, (variant_test::base), (name)(extra) )
 
 using namespace fc;
 
@@ -95,4 +177,387 @@ BOOST_AUTO_TEST_CASE(variant_format_string_limited)
       BOOST_CHECK_LT(result.size(), 1024 + 3 * mu.size());
    }
 }
+
+BOOST_AUTO_TEST_CASE(copies_share_payload)
+{
+   const variant s( std::string( 100, 'x' ) );
+   const variant s2 = s;
+   BOOST_CHECK_EQUAL( &s.get_string(), &s2.get_string() );
+
+   const variant a( variants{ variant( "one" ), variant( 2 ) } );
+   variant a2;
+   a2 = a;
+   BOOST_CHECK_EQUAL( &a.get_array(), &std::as_const( a2 ).get_array() );
+
+   const variant b( blob{ std::vector<char>( 10, 'b' ) } );
+   const variant b2( b );
+   BOOST_CHECK_EQUAL( &b.get_blob(), &b2.get_blob() );
+
+   const variant o( mutable_variant_object( "a", 1 ) );
+   const variant o2( o );
+   BOOST_CHECK_EQUAL( &o.get_object(), &o2.get_object() );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_access_unshares)
+{
+   variant a( variants{ variant( "one" ), variant( 2 ) } );
+   variant b = a;
+
+   variants& arr = b.get_array();
+   BOOST_CHECK_NE( &arr, &std::as_const( a ).get_array() );
+   arr.push_back( variant( 3 ) );
+   BOOST_CHECK_EQUAL( a.size(), 2u );
+   BOOST_CHECK_EQUAL( b.size(), 3u );
+
+   // b handed out a mutable reference, so its copies must not observe later writes through it
+   variant c = b;
+   arr.push_back( variant( 4 ) );
+   BOOST_CHECK_EQUAL( b.size(), 4u );
+   BOOST_CHECK_EQUAL( c.size(), 3u );
+
+   variant d( blob{ std::vector<char>( 4, 'd' ) } );
+   variant e = d;
+   e.get_blob().data[0] = 'e';
+   BOOST_CHECK_EQUAL( std::as_const( d ).get_blob().data[0], 'd' );
+   BOOST_CHECK_EQUAL( std::as_const( e ).get_blob().data[0], 'e' );
+
+   variant f( mutable_variant_object( "a", 1 ) );
+   variant g = f;
+   g.get_object() = mutable_variant_object( "b", 2 );
+   BOOST_CHECK( f.get_object().contains( "a" ) );
+   BOOST_CHECK( g.get_object().contains( "b" ) );
+}
+
+BOOST_AUTO_TEST_CASE(assign_from_own_element)
+{
+   variant v( variants{ variant( std::string( 100, 'x' ) ), variant( 2 ) } );
+   v = v[size_t(0)];
+   BOOST_REQUIRE( v.is_string() );
+   BOOST_CHECK_EQUAL( v.get_string(), std::string( 100, 'x' ) );
+
+   variant o( mutable_variant_object( "a", variants{ variant( 1 ), variant( 2 ) } ) );
+   o = o["a"];
+   BOOST_REQUIRE( o.is_array() );
+   BOOST_CHECK_EQUAL( o.size(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE(variant_copy_benchmark)
+{
+   const size_t num_transactions = 100;
+   const size_t loops = 10; // 1000
+   const variant_test::block blk = variant_test::make_block( num_transactions );
+
+   variant v;
+   auto start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      fc::to_variant( blk, v );
+   auto to_variant_time = fc::time_point::now() - start;
+
+   variant_test::block out;
+   start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i )
+      fc::from_variant( v, out );
+   auto from_variant_time = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( out.transactions.size(), num_transactions );
+   BOOST_CHECK( out.transactions.back().actions.back().data == blk.transactions.back().actions.back().data );
+
+   size_t total = 0;
+   start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i ) {
+      variant copy = v;
+      total += copy["transactions"].size();
+   }
+   auto copy_time = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( total, loops * num_transactions );
+
+   ilog( "${n} blocks of ${t} transactions: to_variant ${tv} us, from_variant ${fv} us, copy ${c} us",
+         ("n", loops)("t", num_transactions)("tv", to_variant_time.count())("fv", from_variant_time.count())
+         ("c", copy_time.count()) );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_variant_object_indexed_find)
+{
+   const size_t n = 100;
+   mutable_variant_object mvo;
+   for( size_t i = 0; i < n; ++i )
+      mvo.set( "key" + std::to_string( i ), variant( i ) );
+   BOOST_CHECK_EQUAL( mvo.size(), n );
+
+   // set on an existing key replaces the value in place
+   mvo.set( "key50", variant( "fifty" ) );
+   BOOST_CHECK_EQUAL( mvo.size(), n );
+   BOOST_CHECK_EQUAL( mvo["key50"].get_string(), "fifty" );
+   for( size_t i = 0; i < n; ++i )
+      BOOST_CHECK_EQUAL( mvo.find( "key" + std::to_string( i ) ) - mvo.begin(), static_cast<int64_t>( i ) );
+   BOOST_CHECK( mvo.find( "missing" ) == mvo.end() );
+
+   // operator() with a variant does not look for duplicates, find returns the first one like a linear search
+   mvo( std::string( "key7" ), variant( "seven" ) );
+   BOOST_CHECK_EQUAL( mvo.size(), n + 1 );
+   BOOST_CHECK_EQUAL( mvo["key7"].as_uint64(), 7u );
+
+   mvo.erase( "key0" );
+   BOOST_CHECK( mvo.find( "key0" ) == mvo.end() );
+   BOOST_CHECK_EQUAL( mvo["key1"].as_uint64(), 1u );
+   BOOST_CHECK_EQUAL( mvo.find( "key1" ) - mvo.begin(), 0 );
+
+   mvo["added"] = variant( 1 );
+   BOOST_CHECK_EQUAL( mvo.find( "added" ) - mvo.begin(), static_cast<int64_t>( mvo.size() - 1 ) );
+
+   mutable_variant_object moved( std::move( mvo ) );
+   moved.append_unique( "appended", variant( 2 ) );
+   BOOST_CHECK_EQUAL( moved["appended"].as_uint64(), 2u );
+   BOOST_CHECK_EQUAL( moved["key99"].as_uint64(), 99u );
+
+   const variant_object vo = moved;
+   BOOST_CHECK_EQUAL( vo.size(), moved.size() );
+   BOOST_CHECK_EQUAL( vo["appended"].as_uint64(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_variant_object_concurrent_const_find)
+{
+   // const lookups only read the index, so they may run on several threads at once
+   mutable_variant_object mvo;
+   for( size_t i = 0; i < 64; ++i )
+      mvo.append_unique( "key" + std::to_string( i ), variant( i ) );
+   const mutable_variant_object copy( mvo );
+   const mutable_variant_object from_vo{ variant_object( mvo ) };
+
+   std::atomic<size_t> found{0};
+   std::vector<std::thread> threads;
+   for( size_t t = 0; t < 4; ++t ) {
+      threads.emplace_back( [&]() {
+         for( size_t i = 0; i < 64; ++i ) {
+            const std::string key = "key" + std::to_string( i );
+            found += copy[key].as_uint64() == i;
+            found += from_vo[key].as_uint64() == i;
+         }
+      } );
+   }
+   for( auto& t : threads )
+      t.join();
+   BOOST_CHECK_EQUAL( found.load(), 4u * 64u * 2u );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_variant_object_modify_through_iterators)
+{
+   // entries reached through an iterator can change their value but not be replaced or reordered
+   static_assert( !std::is_copy_assignable_v<variant_object::entry> );
+   static_assert( !std::is_move_assignable_v<variant_object::entry> );
+
+   mutable_variant_object mvo;
+   for( size_t i = 0; i < 32; ++i )
+      mvo.append_unique( "key" + std::to_string( i ), variant( i ) );
+
+   for( auto itr = mvo.begin(); itr != mvo.end(); ++itr )
+      itr->set( variant( itr->value().as_uint64() + 100 ) );
+   mvo.begin()->value() = variant( 1000 );
+
+   for( size_t i = 0; i < 32; ++i ) {
+      const std::string key = "key" + std::to_string( i );
+      BOOST_REQUIRE( mvo.find( key ) != mvo.end() );
+      BOOST_CHECK_EQUAL( mvo[key].as_uint64(), i == 0 ? 1000u : i + 100 );
+   }
+
+   // lookups through the index still find every key, so set() replaces instead of appending
+   mvo.set( "key31", variant( 7 ) );
+   mvo["key5"] = variant( 8 );
+   BOOST_CHECK_EQUAL( mvo.size(), 32u );
+   BOOST_CHECK_EQUAL( mvo["key31"].as_uint64(), 7u );
+   BOOST_CHECK_EQUAL( mvo["key5"].as_uint64(), 8u );
+
+   // erase shifts the remaining entries and keeps them findable
+   mvo.erase( "key3" );
+   BOOST_CHECK_EQUAL( mvo.size(), 31u );
+   BOOST_CHECK( mvo.find( "key3" ) == mvo.end() );
+   BOOST_CHECK_EQUAL( ( mvo.begin() + 3 )->key(), "key4" );
+   BOOST_CHECK_EQUAL( mvo["key31"].as_uint64(), 7u );
+}
+
+BOOST_AUTO_TEST_CASE(reflected_to_variant_member_names)
+{
+   static_assert( fc::detail::has_unique_member_names<variant_test::block>() );
+   static_assert( !fc::detail::has_unique_member_names<variant_test::derived>() );
+
+   variant_test::derived d;
+   d.id = 1;
+   d.base::name = "base";
+   d.name = "derived";
+   d.extra = 2;
+   variant v;
+   fc::to_variant( d, v );
+   const variant_object& vo = v.get_object();
+   BOOST_REQUIRE_EQUAL( vo.size(), 3u );
+   BOOST_CHECK_EQUAL( vo["name"].get_string(), "derived" );
+   BOOST_CHECK_EQUAL( vo["extra"].as_uint64(), 2u );
+}
+
+BOOST_AUTO_TEST_CASE(mutable_variant_object_benchmark)
+{
+   const size_t loops = 100; // 10000
+   for( size_t n : { 8, 32, 128 } ) {
+      std::vector<std::string> keys;
+      for( size_t i = 0; i < n; ++i )
+         keys.push_back( "field_" + std::to_string( i ) );
+
+      auto start = fc::time_point::now();
+      for( size_t l = 0; l < loops; ++l ) {
+         mutable_variant_object mvo;
+         for( const auto& k : keys )
+            mvo.set( k, variant( l ) );
+         BOOST_CHECK_EQUAL( mvo.size(), n );
+      }
+      auto set_time = fc::time_point::now() - start;
+
+      start = fc::time_point::now();
+      for( size_t l = 0; l < loops; ++l ) {
+         mutable_variant_object mvo;
+         mvo.reserve( n );
+         for( const auto& k : keys )
+            mvo.append_unique( k, variant( l ) );
+         BOOST_CHECK_EQUAL( mvo.size(), n );
+      }
+      auto append_time = fc::time_point::now() - start;
+
+      ilog( "${l} objects of ${n} fields: set ${s} us, append_unique ${a} us",
+            ("l", loops)("n", n)("s", set_time.count())("a", append_time.count()) );
+   }
+}
+
+BOOST_AUTO_TEST_CASE(reflected_keys_are_not_copied)
+{
+   const variant_test::long_names ln;
+   variant v;
+   fc::to_variant( ln, v ); // creates the static keys
+
+   variant reflected_keys;
+   fc::to_variant( ln, reflected_keys );
+
+   mutable_variant_object mvo;
+   mvo.reserve( 4 );
+   mvo( "first_long_member_name", ln.first_long_member_name )( "second_long_member_name", ln.second_long_member_name )
+      ( "third_long_member_name", ln.third_long_member_name )( "fourth_long_member_name", ln.fourth_long_member_name );
+   variant copied_keys( std::move( mvo ) );
+
+   // a key that was not copied is the same string object in every converted object
+   auto count_shared_keys = []( const variant_object& a, const variant_object& b ) {
+      size_t n = 0;
+      for( auto i = a.begin(), j = b.begin(); i != a.end() && j != b.end(); ++i, ++j )
+         n += &i->key() == &j->key();
+      return n;
+   };
+   BOOST_CHECK_EQUAL( count_shared_keys( v.get_object(), reflected_keys.get_object() ), 4u );
+   BOOST_CHECK_EQUAL( count_shared_keys( v.get_object(), copied_keys.get_object() ), 0u );
+   BOOST_CHECK( std::equal( v.get_object().begin(), v.get_object().end(),
+                            copied_keys.get_object().begin(), copied_keys.get_object().end() ) );
+
+   // the keys are found by address and by value
+   const variant_object& vo = v.get_object();
+   BOOST_CHECK_EQUAL( &vo.begin()->key(),
+                      (fc::reflected_member_key<uint64_t, variant_test::long_names, &variant_test::long_names::first_long_member_name>( "" )) );
+   variant_test::long_names out{ 0, 0, 0, 0 };
+   fc::from_variant( v, out );
+   BOOST_CHECK_EQUAL( out.fourth_long_member_name, 4u );
+   fc::from_variant( copied_keys, out );
+   BOOST_CHECK_EQUAL( out.third_long_member_name, 3u );
+   BOOST_CHECK( vo.find( "second_long_member_name" ) != vo.end() );
+
+   // copies of entries with static keys keep referring to them
+   mutable_variant_object m( vo );
+   m.set( "first_long_member_name", variant( 10 ) );
+   const variant_object vo2( m );
+   BOOST_CHECK_EQUAL( &vo2.begin()->key(), &vo.begin()->key() );
+   BOOST_CHECK_EQUAL( vo2["first_long_member_name"].as_uint64(), 10u );
+}
+
+BOOST_AUTO_TEST_CASE(checked_from_variant)
+{
+   const variant_test::block blk = variant_test::make_block( 3 );
+   const variant v( blk );
+
+   from_variant_error err;
+   std::optional<variant_test::block> out = v.as_checked<variant_test::block>( err );
+   BOOST_REQUIRE( out );
+   BOOST_CHECK( !err );
+   BOOST_CHECK_EQUAL( out->producer, blk.producer );
+   BOOST_CHECK( out->transactions[1].expiration == blk.transactions[1].expiration );
+   BOOST_REQUIRE_EQUAL( out->transactions.size(), 3u );
+   BOOST_CHECK( out->transactions[2].actions[1].data == blk.transactions[2].actions[1].data );
+
+   out = variant( 5 ).as_checked<variant_test::block>( err );
+   BOOST_CHECK( !out );
+   BOOST_CHECK_EQUAL( err.code, from_variant_error::type_mismatch );
+   BOOST_CHECK_EQUAL( err.path, "" );
+
+   const variant bad = fc::json::from_string(
+      R"({"producer":"p","transactions":[{"ref_block_num":1,"actions":[]},)"
+      R"({"ref_block_num":2,"actions":[{"account":"a"},{"account":"b","name":{"x":1}}]}]})" );
+   err = from_variant_error();
+   BOOST_CHECK( !bad.as_checked<variant_test::block>( err ) );
+   BOOST_CHECK_EQUAL( err.code, from_variant_error::type_mismatch );
+   BOOST_CHECK_EQUAL( err.path, "transactions[1].actions[1].name" );
+
+   const variant unparsable = fc::json::from_string( R"({"transactions":[{"ref_block_num":"x1"}]})" );
+   err = from_variant_error();
+   BOOST_CHECK( !unparsable.as_checked<variant_test::block>( err ) );
+   BOOST_CHECK_EQUAL( err.code, from_variant_error::invalid_value );
+   BOOST_CHECK_EQUAL( err.path, "transactions[0].ref_block_num" );
+
+   // the throwing conversion reports the same error
+   BOOST_CHECK_EXCEPTION( bad.as<variant_test::block>(), bad_cast_exception, []( const bad_cast_exception& e ) {
+      return e.to_detail_string().find( "variant_test::block.transactions[1].actions[1].name" ) != std::string::npos;
+   } );
+   BOOST_CHECK_THROW( unparsable.as<variant_test::block>(), parse_error_exception );
+}
+
+BOOST_AUTO_TEST_CASE(checked_from_variant_uses_own_from_variant)
+{
+   const variant v = fc::json::from_string( R"({"id":"id:5","more":["id:6","id:7"]})" );
+   from_variant_error err;
+   auto ids = v.as_checked<variant_test::with_ids>( err );
+   BOOST_REQUIRE( ids );
+   BOOST_CHECK_EQUAL( ids->id.value, 5u );
+   BOOST_REQUIRE_EQUAL( ids->more.size(), 2u );
+   BOOST_CHECK_EQUAL( ids->more[1].value, 7u );
+
+   const variant bad = fc::json::from_string( R"({"id":"id:5","more":["id:6","7"]})" );
+   BOOST_CHECK( !bad.as_checked<variant_test::with_ids>( err ) );
+   BOOST_CHECK_EQUAL( err.code, from_variant_error::conversion_failed );
+   BOOST_CHECK_EQUAL( err.path, "more[1]" );
+   BOOST_CHECK( err.nested );
+
+   // the exception of the type's own from_variant is rethrown
+   BOOST_CHECK_THROW( bad.as<variant_test::with_ids>(), assert_exception );
+}
+
+BOOST_AUTO_TEST_CASE(checked_from_variant_benchmark)
+{
+   const size_t loops = 100; // 100000
+   const variant bad = fc::json::from_string(
+      R"({"producer":"p","transactions":[{"ref_block_num":1,"actions":[]},)"
+      R"({"ref_block_num":2,"actions":[{"account":"a"},{"account":"b","name":{"x":1}}]}]})" );
+
+   size_t failures = 0;
+   auto start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i ) {
+      try {
+         bad.as<variant_test::block>();
+      } catch( const fc::exception& ) {
+         ++failures;
+      }
+   }
+   auto throwing_time = fc::time_point::now() - start;
+
+   start = fc::time_point::now();
+   for( size_t i = 0; i < loops; ++i ) {
+      from_variant_error err;
+      if( !bad.as_checked<variant_test::block>( err ) )
+         ++failures;
+   }
+   auto checked_time = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( failures, 2 * loops );
+
+   ilog( "${n} failing conversions: throwing ${t} us, checked ${c} us",
+         ("n", loops)("t", throwing_time.count())("c", checked_time.count()) );
+}
 BOOST_AUTO_TEST_SUITE_END()